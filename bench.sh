@@ -0,0 +1,123 @@
+#!/bin/bash
+
+# IMX8MP Sensor Simulator Benchmark Script
+# Builds sensor_bench (Release) and writes JSON results for regression tracking
+
+set -e
+
+# Colors for output
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m' # No Color
+
+# Default values
+BUILD_TYPE="native"
+BUILD_DIR="build-bench"
+OUTPUT=""
+FILTER=""
+
+# Function to print colored output
+print_status() {
+    echo -e "${GREEN}[INFO]${NC} $1"
+}
+
+print_warning() {
+    echo -e "${YELLOW}[WARNING]${NC} $1"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR]${NC} $1"
+}
+
+# Function to show usage
+show_usage() {
+    echo "Usage: $0 [OPTIONS]"
+    echo ""
+    echo "Options:"
+    echo "  -t, --type TYPE        Build type: native, cross (default: native)"
+    echo "  -d, --dir DIR          Build directory (default: build-bench)"
+    echo "  -o, --output FILE      JSON results file (default: sensor_bench-<type>-<git rev>.json)"
+    echo "  -f, --filter REGEX     Only run benchmarks matching REGEX"
+    echo "  -h, --help             Show this help message"
+    echo ""
+    echo "Environment:"
+    echo "  MOSQUITTO_BIN          Broker binary used for the MQTT publish cases (default: mosquitto)"
+    echo "  BENCH_MQTT_PORT        Port for the spawned broker (default: 18830)"
+    echo ""
+    echo "Cross builds cannot run on the host; copy sensor_bench to the target and run:"
+    echo "  ./sensor_bench --benchmark_out=results.json --benchmark_out_format=json"
+}
+
+# Parse command line arguments
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        -t|--type)
+            BUILD_TYPE="$2"
+            shift 2
+            ;;
+        -d|--dir)
+            BUILD_DIR="$2"
+            shift 2
+            ;;
+        -o|--output)
+            OUTPUT="$2"
+            shift 2
+            ;;
+        -f|--filter)
+            FILTER="$2"
+            shift 2
+            ;;
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        *)
+            print_error "Unknown option: $1"
+            show_usage
+            exit 1
+            ;;
+    esac
+done
+
+# Validate build type
+if [[ "$BUILD_TYPE" != "native" && "$BUILD_TYPE" != "cross" ]]; then
+    print_error "Invalid build type: $BUILD_TYPE"
+    print_error "Valid types: native, cross"
+    exit 1
+fi
+
+if [[ -z "$OUTPUT" ]]; then
+    REV=$(git rev-parse --short HEAD 2>/dev/null || echo "unknown")
+    OUTPUT="$(pwd)/sensor_bench-${BUILD_TYPE}-${REV}.json"
+fi
+
+CMAKE_ARGS="-DCMAKE_BUILD_TYPE=Release -DBUILD_BENCHMARKS=ON"
+if [[ "$BUILD_TYPE" == "cross" ]]; then
+    CMAKE_ARGS="$CMAKE_ARGS -DCMAKE_TOOLCHAIN_FILE=$(pwd)/toolchain-imx8mp.cmake"
+    BUILD_DIR="${BUILD_DIR}-cross"
+fi
+
+print_status "Configuring $BUILD_TYPE benchmark build in $BUILD_DIR"
+cmake -S . -B "$BUILD_DIR" $CMAKE_ARGS
+cmake --build "$BUILD_DIR" --target sensor_bench -j"$(nproc)"
+
+if [[ ! -f "$BUILD_DIR/sensor_bench" ]]; then
+    print_error "sensor_bench was not built. Is Google Benchmark installed (libbenchmark-dev)?"
+    exit 1
+fi
+
+if [[ "$BUILD_TYPE" == "cross" ]]; then
+    print_status "Cross build complete: $BUILD_DIR/sensor_bench"
+    print_warning "Copy it to the target and run it there with --benchmark_out_format=json"
+    exit 0
+fi
+
+BENCH_ARGS="--benchmark_out=$OUTPUT --benchmark_out_format=json"
+if [[ -n "$FILTER" ]]; then
+    BENCH_ARGS="$BENCH_ARGS --benchmark_filter=$FILTER"
+fi
+
+print_status "Running sensor_bench"
+"$BUILD_DIR/sensor_bench" $BENCH_ARGS
+print_status "Results written to $OUTPUT"
@@ -0,0 +1,600 @@
+// Micro-benchmarks for the sensor pipeline: simulation, protobuf
+// serialization, action dispatch and MQTT publishing.
+//
+// Run with --benchmark_format=json (or the `bench` CMake target) to get
+// machine-readable output for release-to-release regression tracking.
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "sensor_simulator.h"
+#include "protobuf_converter.h"
+#include "mqtt_client.h"
+#include "action_handler.h"
+#include "sensor_consumer.h"
+#include "sensor_aggregator.h"
+#include "sensor_fusion.h"
+#include "shm_ring.h"
+#include "history_store.h"
+#include "nmea_parser.h"
+#include "status_template.h"
+
+extern char** environ;
+
+// ---------------------------------------------------------------------------
+// Allocation counting
+//
+// Every operator new in the process bumps this counter. Allocations made by
+// libmosquitto itself go through malloc() and are not included.
+// ---------------------------------------------------------------------------
+static std::atomic<uint64_t> g_alloc_count{0};
+
+void* operator new(std::size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC flags free() on memory from the replaced operator new as a mismatch;
+// both sides are replaced here, so the pairing is correct.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#pragma GCC diagnostic pop
+
+namespace {
+
+// Reports allocations per iteration for the enclosing benchmark
+class AllocCounter {
+public:
+    explicit AllocCounter(benchmark::State& state)
+        : state_(state), start_(g_alloc_count.load(std::memory_order_relaxed)) {}
+
+    ~AllocCounter() {
+        uint64_t allocs = g_alloc_count.load(std::memory_order_relaxed) - start_;
+        state_.counters["allocs_per_op"] =
+            benchmark::Counter(static_cast<double>(allocs), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& state_;
+    uint64_t start_;
+};
+
+SensorData sampleData() {
+    SensorSimulator simulator;
+    return simulator.generateSensorData();
+}
+
+// ---------------------------------------------------------------------------
+// Local mosquitto broker, spawned on first use and killed at exit.
+// Set MOSQUITTO_BIN to override the broker binary, BENCH_MQTT_PORT the port.
+// ---------------------------------------------------------------------------
+class LocalBroker {
+public:
+    static LocalBroker& instance() {
+        static LocalBroker broker;
+        return broker;
+    }
+
+    bool running() const { return pid_ > 0; }
+    int port() const { return port_; }
+
+private:
+    LocalBroker() {
+        const char* bin = std::getenv("MOSQUITTO_BIN");
+        const char* port_env = std::getenv("BENCH_MQTT_PORT");
+        port_ = port_env ? std::atoi(port_env) : 18830;
+
+        std::string port_str = std::to_string(port_);
+        const char* binary = bin ? bin : "mosquitto";
+        char* argv[] = {const_cast<char*>(binary), const_cast<char*>("-p"),
+                        const_cast<char*>(port_str.c_str()), nullptr};
+        if (posix_spawnp(&pid_, binary, nullptr, nullptr, argv, environ) != 0) {
+            pid_ = -1;
+            return;
+        }
+        // Give the broker a moment to bind its listener
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        int status = 0;
+        if (waitpid(pid_, &status, WNOHANG) != 0) {
+            pid_ = -1;
+        }
+    }
+
+    ~LocalBroker() {
+        if (pid_ > 0) {
+            kill(pid_, SIGTERM);
+            waitpid(pid_, nullptr, 0);
+        }
+    }
+
+    pid_t pid_ = -1;
+    int port_ = 0;
+};
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Simulator
+// ---------------------------------------------------------------------------
+static void BM_GenerateSensorData(benchmark::State& state) {
+    SensorSimulator simulator;
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        SensorData data = simulator.generateSensorData();
+        benchmark::DoNotOptimize(data);
+    }
+}
+BENCHMARK(BM_GenerateSensorData);
+
+static void BM_AggregatorAddSample(benchmark::State& state) {
+    // 60 s window sliding every range(0) ms
+    SensorAggregator aggregator(60000, state.range(0));
+    SensorSimulator simulator;
+    SensorData data = simulator.generateSensorData();
+    SensorAggregate aggregate;
+    int64_t tick = 0;
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        data.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(tick += 100));
+        bool emitted = aggregator.addSample(data, aggregate);
+        benchmark::DoNotOptimize(emitted);
+    }
+}
+BENCHMARK(BM_AggregatorAddSample)->ArgName("slide_ms")->Arg(60000)->Arg(1000);
+
+// Per-device cost of the Kalman fusion stage, one filter at a time
+static void BM_FusionScalar(benchmark::State& state) {
+    const size_t num_devices = static_cast<size_t>(state.range(0));
+    std::vector<SensorFusion> filters(num_devices);
+    std::vector<SensorData> samples(num_devices, sampleData());
+    int64_t tick = 0;
+    for (auto _ : state) {
+        auto ts = std::chrono::system_clock::time_point(std::chrono::milliseconds(tick += 100));
+        for (size_t d = 0; d < num_devices; d++) {
+            samples[d].timestamp = ts;
+            filters[d].apply(samples[d]);
+        }
+        benchmark::DoNotOptimize(samples.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_devices);
+}
+BENCHMARK(BM_FusionScalar)->ArgName("devices")->Arg(1024);
+
+// Same workload stepped SensorFusionBatch::kLanes devices per pass
+static void BM_FusionBatch(benchmark::State& state) {
+    const size_t num_devices = static_cast<size_t>(state.range(0));
+    SensorFusionBatch batch(num_devices);
+    std::vector<SensorData> samples(num_devices, sampleData());
+    int64_t tick = 0;
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        auto ts = std::chrono::system_clock::time_point(std::chrono::milliseconds(tick += 100));
+        for (SensorData& s : samples) {
+            s.timestamp = ts;
+        }
+        batch.apply(samples.data(), samples.size());
+        benchmark::DoNotOptimize(samples.data());
+    }
+    state.SetItemsProcessed(state.iterations() * num_devices);
+}
+BENCHMARK(BM_FusionBatch)->ArgName("devices")->Arg(1024);
+
+// ---------------------------------------------------------------------------
+// Serialization
+// ---------------------------------------------------------------------------
+static void BM_SensorDataToProtobuf(benchmark::State& state) {
+    SensorData data = sampleData();
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        std::string pb = ProtobufConverter::sensorDataToProtobuf(data, "bench_device");
+        benchmark::DoNotOptimize(pb);
+    }
+}
+BENCHMARK(BM_SensorDataToProtobuf);
+
+static void BM_TemperatureToProtobuf(benchmark::State& state) {
+    SensorData data = sampleData();
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        std::string pb = ProtobufConverter::temperatureToProtobuf(data, "bench_device");
+        benchmark::DoNotOptimize(pb);
+    }
+}
+BENCHMARK(BM_TemperatureToProtobuf);
+
+static void BM_CompassToProtobuf(benchmark::State& state) {
+    SensorData data = sampleData();
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        std::string pb = ProtobufConverter::compassToProtobuf(data, "bench_device");
+        benchmark::DoNotOptimize(pb);
+    }
+}
+BENCHMARK(BM_CompassToProtobuf);
+
+static void BM_GpsToProtobuf(benchmark::State& state) {
+    SensorData data = sampleData();
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        std::string pb = ProtobufConverter::gpsToProtobuf(data, "bench_device");
+        benchmark::DoNotOptimize(pb);
+    }
+}
+BENCHMARK(BM_GpsToProtobuf);
+
+static void BM_ValidateMessage(benchmark::State& state) {
+    std::string pb = ProtobufConverter::sensorDataToProtobuf(sampleData(), "bench_device");
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        bool ok = ProtobufConverter::validateMessage(pb);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pb.size()));
+}
+BENCHMARK(BM_ValidateMessage);
+
+// Status built from scratch vs. patched into a cached template
+static void BM_CreateOnlineStatus(benchmark::State& state) {
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        std::string pb = ProtobufConverter::createOnlineStatus("bench_device");
+        benchmark::DoNotOptimize(pb);
+    }
+}
+BENCHMARK(BM_CreateOnlineStatus);
+
+static void BM_StatusTemplate(benchmark::State& state) {
+    StatusTemplate status("bench_device", sensor::StatusMessage::ONLINE, "Sensor simulator online");
+    int64_t now_ms = ProtobufConverter::timestampToUnixMs(std::chrono::system_clock::now());
+    status.at(now_ms);
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        const std::string& pb = status.at(++now_ms);
+        benchmark::DoNotOptimize(pb.data());
+    }
+}
+BENCHMARK(BM_StatusTemplate);
+
+// One heartbeat pass over a fleet of templates
+static void BM_HeartbeatFleet(benchmark::State& state) {
+    std::vector<StatusTemplate> fleet;
+    for (int64_t d = 0; d < state.range(0); d++) {
+        fleet.emplace_back("bench_device_" + std::to_string(d), sensor::StatusMessage::HEARTBEAT, "");
+    }
+    int64_t now_ms = ProtobufConverter::timestampToUnixMs(std::chrono::system_clock::now());
+    size_t bytes = 0;
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        now_ms += 1000;
+        for (auto& status : fleet) {
+            bytes += status.at(now_ms).size();
+        }
+    }
+    benchmark::DoNotOptimize(bytes);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HeartbeatFleet)->ArgName("devices")->Arg(10000);
+
+// ---------------------------------------------------------------------------
+// Consumer SDK
+// ---------------------------------------------------------------------------
+static void BM_WireDecodeSensorData(benchmark::State& state) {
+    std::string pb = ProtobufConverter::sensorDataToProtobuf(sampleData(), "bench_device");
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        DecodedSample sample;
+        bool ok = SensorWireDecoder::decodeSensorData(pb.data(), pb.size(), sample);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(sample);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pb.size()));
+}
+BENCHMARK(BM_WireDecodeSensorData);
+
+// Mixed sensor/# stream from range(0) devices, ingested into columnar rings
+static void BM_ConsumerIngest(benchmark::State& state) {
+    const int num_devices = static_cast<int>(state.range(0));
+    struct Message {
+        const char* topic;
+        std::string payload;
+    };
+    std::vector<Message> stream;
+    SensorSimulator simulator;
+    for (int d = 0; d < num_devices; d++) {
+        SensorData data = simulator.generateSensorData();
+        std::string id = "device_" + std::to_string(d);
+        stream.push_back({"sensor/all", ProtobufConverter::sensorDataToProtobuf(data, id)});
+        stream.push_back({"sensor/temperature", ProtobufConverter::temperatureToProtobuf(data, id)});
+        stream.push_back({"sensor/compass", ProtobufConverter::compassToProtobuf(data, id)});
+        stream.push_back({"sensor/gps", ProtobufConverter::gpsToProtobuf(data, id)});
+    }
+
+    SensorConsumer consumer(1024, num_devices);
+    for (const Message& m : stream) {
+        consumer.ingest(m.topic, m.payload.data(), m.payload.size());  // create devices up front
+    }
+
+    size_t i = 0;
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        const Message& m = stream[i];
+        bool ok = consumer.ingest(m.topic, m.payload.data(), m.payload.size());
+        benchmark::DoNotOptimize(ok);
+        if (++i == stream.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConsumerIngest)->ArgName("devices")->Arg(1)->Arg(100);
+
+// Lock-free scan of a full ring computing the mean temperature
+static void BM_ColumnarScan(benchmark::State& state) {
+    ColumnarRing<6> ring(4096);
+    SensorSimulator simulator;
+    for (size_t i = 0; i < ring.capacity(); i++) {
+        SensorData d = simulator.generateSensorData();
+        ring.append(i, i, {d.cpu_temperature, d.compass_heading, d.gps_latitude,
+                           d.gps_longitude, d.gps_altitude, 5.0});
+    }
+    for (auto _ : state) {
+        double sum = 0.0;
+        ring.scan(0, [&sum](const ColumnarRing<6>::Segment& seg) {
+            for (size_t i = 0; i < seg.count; i++) {
+                sum += seg.valueAt(DeviceStreams::kCpuTemperature, i);
+            }
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * ring.capacity());
+}
+BENCHMARK(BM_ColumnarScan);
+
+// ---------------------------------------------------------------------------
+// Shared-memory transport
+// ---------------------------------------------------------------------------
+static void BM_ShmPublishReadLatest(benchmark::State& state) {
+    ShmRingWriter writer;
+    ShmRingReader reader;
+    std::string name = "sensor_bench_" + std::to_string(getpid());
+    if (!writer.open(name, 1024) || !reader.open(name)) {
+        state.SkipWithError("shared memory unavailable");
+        return;
+    }
+    SensorData data = sampleData();
+    ShmSample sample;
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        writer.publish(data);
+        bool ok = reader.readLatest(sample);
+        benchmark::DoNotOptimize(ok);
+    }
+}
+BENCHMARK(BM_ShmPublishReadLatest);
+
+// ---------------------------------------------------------------------------
+// Compressed history
+// ---------------------------------------------------------------------------
+static void BM_HistoryAppend(benchmark::State& state) {
+    HistoryStore store;
+    SensorSimulator simulator;
+    std::vector<SensorData> samples(4096);
+    for (auto& sample : samples) {
+        sample = simulator.generateSensorData();
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        store.append(samples[i++ & (samples.size() - 1)]);
+    }
+    HistoryStore::Stats stats = store.stats();
+    if (stats.compressed_bytes > 0) {
+        state.counters["ratio"] = static_cast<double>(stats.raw_bytes) / stats.compressed_bytes;
+    }
+}
+BENCHMARK(BM_HistoryAppend);
+
+// ---------------------------------------------------------------------------
+// NMEA parsing
+// ---------------------------------------------------------------------------
+// One 10 Hz receiver epoch, fed in reads of `chunk` bytes
+static void BM_NmeaParseEpoch(benchmark::State& state) {
+    const std::string epoch =
+        "$GNGGA,123000.00,3746.4943,N,12225.1636,W,1,09,0.90,16.0,M,-25.7,M,,*42\r\n"
+        "$GNRMC,123000.00,A,3746.4943,N,12225.1636,W,15.279,44.47,181026,,,A*6D\r\n"
+        "$GNVTG,44.47,T,,M,15.279,N,28.297,K,A*1E\r\n";
+    const size_t chunk = static_cast<size_t>(state.range(0));
+    NmeaParser parser;
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        for (size_t offset = 0; offset < epoch.size(); offset += chunk) {
+            parser.feed(epoch.data() + offset, std::min(chunk, epoch.size() - offset));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * epoch.size());
+}
+BENCHMARK(BM_NmeaParseEpoch)->ArgName("read_bytes")->Arg(16)->Arg(4096);
+
+// ---------------------------------------------------------------------------
+// Action dispatch
+// ---------------------------------------------------------------------------
+static void BM_ActionDispatch(benchmark::State& state) {
+    ActionHandler handler;
+    const char* actions[] = {"reboot", "message", "status", "config", "history", "ping"};
+    for (const char* action : actions) {
+        handler.register_action_handler(action, [](const std::string& payload) {
+            return payload;
+        });
+    }
+    const std::string topic = "ping";
+    const std::string payload = "payload";
+    AllocCounter allocs(state);
+    for (auto _ : state) {
+        auto result = handler.run_handler(topic, payload);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_ActionDispatch);
+
+// ---------------------------------------------------------------------------
+// MQTT publish against a locally spawned broker
+// ---------------------------------------------------------------------------
+static void BM_MqttPublish(benchmark::State& state) {
+    LocalBroker& broker = LocalBroker::instance();
+    if (!broker.running()) {
+        state.SkipWithError("mosquitto broker could not be started (set MOSQUITTO_BIN)");
+        return;
+    }
+
+    MqttClient client;
+    client.setClientId("sensor_bench");
+    if (!client.connect("localhost", broker.port())) {
+        state.SkipWithError("failed to connect to local broker");
+        return;
+    }
+    client.loopStart();
+    for (int i = 0; i < 100 && !client.isConnected(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    if (!client.isConnected()) {
+        client.loopStop();
+        state.SkipWithError("local broker did not acknowledge the connection");
+        return;
+    }
+
+    std::string pb = ProtobufConverter::sensorDataToProtobuf(sampleData(), "bench_device");
+    const std::string topic = "bench/sensor/all";
+    {
+        AllocCounter allocs(state);
+        for (auto _ : state) {
+            bool ok = client.publish(topic, pb, static_cast<int>(state.range(0)));
+            benchmark::DoNotOptimize(ok);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pb.size()));
+
+    client.disconnect();
+    client.loopStop();
+}
+BENCHMARK(BM_MqttPublish)->ArgName("qos")->Arg(0)->Arg(1)->UseRealTime();
+
+// One tick of the four raw topics on the telemetry lane, batched or not
+static void BM_MqttPublishTick(benchmark::State& state) {
+    LocalBroker& broker = LocalBroker::instance();
+    if (!broker.running()) {
+        state.SkipWithError("mosquitto broker could not be started (set MOSQUITTO_BIN)");
+        return;
+    }
+
+    MqttClient client;
+    client.setClientId("sensor_bench_tick");
+    client.setBatchingEnabled(state.range(0) != 0);
+    client.setLaneWindow(1024);
+    if (!client.connect("localhost", broker.port())) {
+        state.SkipWithError("failed to connect to local broker");
+        return;
+    }
+    client.loopStart();
+    for (int i = 0; i < 100 && !client.isConnected(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    if (!client.isConnected()) {
+        client.loopStop();
+        state.SkipWithError("local broker did not acknowledge the connection");
+        return;
+    }
+
+    SensorData data = sampleData();
+    const std::string all = ProtobufConverter::sensorDataToProtobuf(data, "bench_device");
+    const std::string temperature = ProtobufConverter::temperatureToProtobuf(data, "bench_device");
+    const std::string compass = ProtobufConverter::compassToProtobuf(data, "bench_device");
+    const std::string gps = ProtobufConverter::gpsToProtobuf(data, "bench_device");
+    for (auto _ : state) {
+        client.begin();
+        client.publish(MqttClient::kTelemetry, "bench/sensor/all", all);
+        client.publish(MqttClient::kTelemetry, "bench/sensor/temperature", temperature);
+        client.publish(MqttClient::kTelemetry, "bench/sensor/compass", compass);
+        client.publish(MqttClient::kTelemetry, "bench/sensor/gps", gps);
+        client.flush();
+    }
+
+    client.disconnect();
+    client.loopStop();
+}
+BENCHMARK(BM_MqttPublishTick)->ArgName("batch")->Arg(0)->Arg(1)->UseRealTime();
+
+// One heartbeat pass over a fleet, stamped from templates and published on the
+// heartbeat lane inside a tick transaction, as main.cpp does. Compare per item
+// with BM_MqttPublishTick, which is four messages.
+static void BM_MqttHeartbeatPass(benchmark::State& state) {
+    LocalBroker& broker = LocalBroker::instance();
+    if (!broker.running()) {
+        state.SkipWithError("mosquitto broker could not be started (set MOSQUITTO_BIN)");
+        return;
+    }
+
+    const size_t devices = static_cast<size_t>(state.range(0));
+    MqttClient client;
+    client.setClientId("sensor_bench_heartbeat");
+    client.setLaneConfig(MqttClient::kHeartbeat, {0, false, 2 * devices, 1});
+    if (!client.connect("localhost", broker.port())) {
+        state.SkipWithError("failed to connect to local broker");
+        return;
+    }
+    client.loopStart();
+    for (int i = 0; i < 100 && !client.isConnected(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    if (!client.isConnected()) {
+        client.loopStop();
+        state.SkipWithError("local broker did not acknowledge the connection");
+        return;
+    }
+
+    std::vector<StatusTemplate> fleet;
+    std::vector<std::string> topics;
+    for (size_t d = 0; d < devices; d++) {
+        std::string id = "bench_device_" + std::to_string(d);
+        fleet.emplace_back(id, sensor::StatusMessage::HEARTBEAT, "");
+        topics.push_back("sensor/heartbeat/" + id);
+    }
+    int64_t now_ms = ProtobufConverter::timestampToUnixMs(std::chrono::system_clock::now());
+    {
+        AllocCounter allocs(state);
+        for (auto _ : state) {
+            now_ms += 1000;
+            client.begin();
+            for (size_t d = 0; d < devices; d++) {
+                client.publish(MqttClient::kHeartbeat, topics[d], fleet[d].at(now_ms));
+            }
+            client.flush();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["dropped"] = static_cast<double>(client.laneStats(MqttClient::kHeartbeat).dropped);
+
+    client.disconnect();
+    client.loopStop();
+}
+BENCHMARK(BM_MqttHeartbeatPass)->ArgName("devices")->Arg(10000)->UseRealTime();
+
+BENCHMARK_MAIN();
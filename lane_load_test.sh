@@ -0,0 +1,94 @@
+#!/bin/bash
+
+# Ack latency under telemetry saturation, with and without priority lanes
+# Spawns a private mosquitto, drives the simulator at a rate that saturates
+# the telemetry path and times 'ping' action acks with sensor_probe.
+
+set -e
+
+# Colors for output
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NC='\033[0m' # No Color
+
+# Default values
+MQTT_PORT="18833"
+RATE=50000
+PING_HZ=50
+DURATION=10
+BUILD_DIR="./build"
+
+print_status() {
+    echo -e "${GREEN}[INFO]${NC} $1"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR]${NC} $1"
+}
+
+show_usage() {
+    echo "Usage: $0 [OPTIONS]"
+    echo ""
+    echo "Options:"
+    echo "  -p, --port PORT          Port for the spawned mosquitto (default: 18833)"
+    echo "  -r, --rate HZ            Simulator tick rate, 4 telemetry messages per tick (default: 50000)"
+    echo "  -P, --ping HZ            Ping actions per second (default: 50)"
+    echo "  -d, --duration SECONDS   Measurement duration per pass (default: 10)"
+    echo "  -B, --build-dir DIR      Directory containing the binaries (default: ./build)"
+    echo "  -h, --help               Show this help message"
+}
+
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        -p|--port) MQTT_PORT="$2"; shift 2 ;;
+        -r|--rate) RATE="$2"; shift 2 ;;
+        -P|--ping) PING_HZ="$2"; shift 2 ;;
+        -d|--duration) DURATION="$2"; shift 2 ;;
+        -B|--build-dir) BUILD_DIR="$2"; shift 2 ;;
+        -h|--help) show_usage; exit 0 ;;
+        *) print_error "Unknown option: $1"; show_usage; exit 1 ;;
+    esac
+done
+
+if ! command -v mosquitto &> /dev/null; then
+    print_error "mosquitto broker not found! Install the mosquitto package."
+    exit 1
+fi
+
+WORK_DIR=$(mktemp -d)
+PIDS=()
+cleanup() {
+    for pid in "${PIDS[@]}"; do kill "$pid" 2>/dev/null || true; done
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+mosquitto -p "$MQTT_PORT" > "$WORK_DIR/broker.log" 2>&1 &
+PIDS+=($!)
+sleep 1
+
+# run_pass LABEL [simulator flags...]
+run_pass() {
+    local label="$1"
+    shift
+    print_status "Pass '$label': simulator at $RATE Hz, $PING_HZ pings/s for $DURATION s"
+
+    "$BUILD_DIR/sensor_simulator" -b "localhost:$MQTT_PORT" --rate "$RATE" "$@" \
+        > "$WORK_DIR/sim-$label.log" 2>&1 &
+    local sim_pid=$!
+    PIDS+=($sim_pid)
+    sleep 2
+
+    # Only the acks are measured; telemetry is left to saturate the broker path
+    "$BUILD_DIR/sensor_probe" -b "localhost:$MQTT_PORT" -t sensor/status --ping "$PING_HZ" \
+        -D "$DURATION" > "$WORK_DIR/probe-$label.log" 2>&1 || true
+
+    kill -INT "$sim_pid" 2>/dev/null || true
+    wait "$sim_pid" 2>/dev/null || true
+
+    grep -E '^(Topic|ack/ping)' "$WORK_DIR/probe-$label.log" || cat "$WORK_DIR/probe-$label.log"
+    echo ""
+}
+
+run_pass lanes
+run_pass no-lanes --no-lanes
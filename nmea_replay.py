@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""
+NMEA Replay for the Sensor Simulator
+Plays a recorded NMEA 0183 log into a pseudo-terminal so the simulator's
+--gps-device backend can be tested without a receiver:
+
+    ./nmea_replay.py nmea/drive_10hz.nmea --link /tmp/ttyGPS --loop &
+    ./build/sensor_simulator --gps-device /tmp/ttyGPS
+
+Sentences are paced by their UTC time field, so a 10 Hz log replays at 10 Hz.
+Writes can be split at random byte boundaries and sentences corrupted to
+exercise the parser's fragment and checksum handling.
+"""
+
+import argparse
+import os
+import random
+import sys
+import termios
+import time
+import tty
+
+
+def epoch_of(line):
+    """UTC time field of a position sentence, or None"""
+    fields = line.split(b',')
+    if len(fields) > 1 and fields[0][3:6] in (b'GGA', b'RMC') and fields[1]:
+        return fields[1]
+    return None
+
+
+def load_epochs(path):
+    """Groups the log into bursts that share one UTC time"""
+    epochs = []
+    current = []
+    current_time = None
+    with open(path, 'rb') as f:
+        for raw in f:
+            line = raw.strip()
+            if not line.startswith(b'$'):
+                continue
+            t = epoch_of(line)
+            if t is not None and t != current_time and current:
+                epochs.append(current)
+                current = []
+            if t is not None:
+                current_time = t
+            current.append(line + b'\r\n')
+    if current:
+        epochs.append(current)
+    return epochs
+
+
+def corrupt(sentence):
+    """Flips one character of the body so the checksum no longer matches"""
+    body_end = sentence.find(b'*')
+    if body_end < 2:
+        return sentence
+    i = random.randrange(1, body_end)
+    return sentence[:i] + bytes([sentence[i] ^ 0x01]) + sentence[i + 1:]
+
+
+def write_paced(fd, data, baud, fragment):
+    """Writes data in random-sized pieces, at no more than the line rate"""
+    offset = 0
+    while offset < len(data):
+        size = random.randint(1, fragment) if fragment > 0 else len(data)
+        piece = data[offset:offset + size]
+        os.write(fd, piece)
+        offset += len(piece)
+        if baud > 0:
+            time.sleep(len(piece) * 10.0 / baud)  # 8N1: 10 bits per byte
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Replay an NMEA log into a pseudo-terminal')
+    parser.add_argument('file', help='NMEA log, one sentence per line')
+    parser.add_argument('--link', default='/tmp/ttyGPS', help='symlink to the pty slave (default: /tmp/ttyGPS)')
+    parser.add_argument('--rate', type=float, default=10.0, help='epochs per second (default: 10)')
+    parser.add_argument('--baud', type=int, default=115200, help='emulated line rate, 0 for unthrottled (default: 115200)')
+    parser.add_argument('--fragment', type=int, default=0, help='split writes into random pieces of up to N bytes')
+    parser.add_argument('--corrupt', type=float, default=0.0, help='fraction of sentences to corrupt (default: 0)')
+    parser.add_argument('--loop', action='store_true', help='replay the log until interrupted')
+    args = parser.parse_args()
+
+    epochs = load_epochs(args.file)
+    if not epochs:
+        print(f"No NMEA sentences in {args.file}", file=sys.stderr)
+        return 1
+
+    master, slave = os.openpty()
+    tty.setraw(slave, termios.TCSANOW)
+    slave_name = os.ttyname(slave)
+    if os.path.lexists(args.link):
+        os.unlink(args.link)
+    os.symlink(slave_name, args.link)
+    print(f"Replaying {len(epochs)} epochs from {args.file} on {args.link} -> {slave_name}")
+
+    sent = 0
+    corrupted = 0
+    try:
+        next_epoch = time.monotonic()
+        while True:
+            for epoch in epochs:
+                burst = b''
+                for sentence in epoch:
+                    if args.corrupt > 0 and random.random() < args.corrupt:
+                        sentence = corrupt(sentence)
+                        corrupted += 1
+                    burst += sentence
+                    sent += 1
+                write_paced(master, burst, args.baud, args.fragment)
+
+                next_epoch += 1.0 / args.rate
+                delay = next_epoch - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+            if not args.loop:
+                break
+    except KeyboardInterrupt:
+        pass
+    finally:
+        print(f"Sent {sent} sentences, {corrupted} corrupted")
+        os.unlink(args.link)
+        os.close(master)
+        os.close(slave)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
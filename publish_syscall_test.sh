@@ -0,0 +1,117 @@
+#!/bin/bash
+
+# Syscalls and TCP segments per 1,000 ticks, with and without per-tick segment
+# coalescing (--no-batch). Coalescing corks the socket for each tick. It is
+# expected to cut segments, not write() calls: libmosquitto writes each packet
+# on its own, and the cork adds two setsockopt() calls per tick.
+# Spawns a private mosquitto, runs the simulator at a fixed rate and attaches
+# strace -c to every simulator thread for the measurement window. Segments
+# are taken from the simulator's socket counters (ss -ti segs_out).
+
+set -e
+
+# Colors for output
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NC='\033[0m' # No Color
+
+# Default values
+MQTT_PORT="18834"
+RATE=1000
+DURATION=10
+BUILD_DIR="./build"
+
+print_status() {
+    echo -e "${GREEN}[INFO]${NC} $1"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR]${NC} $1"
+}
+
+show_usage() {
+    echo "Usage: $0 [OPTIONS]"
+    echo ""
+    echo "Options:"
+    echo "  -p, --port PORT          Port for the spawned mosquitto (default: 18834)"
+    echo "  -r, --rate HZ            Simulator tick rate (default: 1000)"
+    echo "  -d, --duration SECONDS   Measurement window per pass (default: 10)"
+    echo "  -B, --build-dir DIR      Directory containing the binaries (default: ./build)"
+    echo "  -h, --help               Show this help message"
+}
+
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        -p|--port) MQTT_PORT="$2"; shift 2 ;;
+        -r|--rate) RATE="$2"; shift 2 ;;
+        -d|--duration) DURATION="$2"; shift 2 ;;
+        -B|--build-dir) BUILD_DIR="$2"; shift 2 ;;
+        -h|--help) show_usage; exit 0 ;;
+        *) print_error "Unknown option: $1"; show_usage; exit 1 ;;
+    esac
+done
+
+for tool in mosquitto strace ss; do
+    if ! command -v "$tool" &> /dev/null; then
+        print_error "$tool not found!"
+        exit 1
+    fi
+done
+
+WORK_DIR=$(mktemp -d)
+PIDS=()
+cleanup() {
+    for pid in "${PIDS[@]}"; do kill "$pid" 2>/dev/null || true; done
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+mosquitto -p "$MQTT_PORT" > "$WORK_DIR/broker.log" 2>&1 &
+PIDS+=($!)
+sleep 1
+
+# segs_out of the simulator's connection to the broker
+segs_out() {
+    ss -Htin "( dport = :$MQTT_PORT )" | grep -o 'segs_out:[0-9]*' | head -1 | cut -d: -f2
+}
+
+# run_pass LABEL [simulator flags...]
+run_pass() {
+    local label="$1"
+    shift
+    print_status "Pass '$label': simulator at $RATE Hz for $DURATION s"
+
+    "$BUILD_DIR/sensor_simulator" -b "localhost:$MQTT_PORT" --rate "$RATE" --no-history "$@" \
+        > "$WORK_DIR/sim-$label.log" 2>&1 &
+    local sim_pid=$!
+    PIDS+=($sim_pid)
+    sleep 2
+
+    # Attach to every thread: the publishing thread and libmosquitto's loop thread
+    local attach=()
+    for task in /proc/$sim_pid/task/*; do
+        attach+=(-p "${task##*/}")
+    done
+
+    local segs_before
+    segs_before=$(segs_out)
+    timeout -s INT "$DURATION" strace -c -f -o "$WORK_DIR/strace-$label.txt" "${attach[@]}" 2>/dev/null || true
+    local segs_after
+    segs_after=$(segs_out)
+
+    kill -INT "$sim_pid" 2>/dev/null || true
+    wait "$sim_pid" 2>/dev/null || true
+
+    local ticks=$((RATE * DURATION))
+    local calls
+    calls=$(awk '$NF == "total" { print $4 }' "$WORK_DIR/strace-$label.txt")
+    echo "  syscalls per 1000 ticks: $((calls * 1000 / ticks))"
+    echo "  segments per 1000 ticks: $(((segs_after - segs_before) * 1000 / ticks))"
+    echo "  top syscalls:"
+    grep -E ' (write|writev|sendto|sendmsg|read|recvfrom|pselect6|select|ppoll|poll|setsockopt|futex)$' \
+        "$WORK_DIR/strace-$label.txt" | awk -v t="$ticks" '{ printf "    %-12s %8d per 1000 ticks\n", $NF, $4 * 1000 / t }'
+    echo ""
+}
+
+run_pass batched
+run_pass unbatched --no-batch
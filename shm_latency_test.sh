@@ -0,0 +1,88 @@
+#!/bin/bash
+
+# Latency comparison: shared-memory ring vs MQTT loopback
+# Runs the simulator with --shm against a private mosquitto and measures the
+# same samples through both paths with two concurrent sensor_probe instances.
+
+set -e
+
+# Colors for output
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NC='\033[0m' # No Color
+
+# Default values
+MQTT_PORT="18832"
+RATE=1000
+DURATION=10
+SHM_NAME="sensor_latency_test"
+BUILD_DIR="./build"
+
+print_status() {
+    echo -e "${GREEN}[INFO]${NC} $1"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR]${NC} $1"
+}
+
+show_usage() {
+    echo "Usage: $0 [OPTIONS]"
+    echo ""
+    echo "Options:"
+    echo "  -p, --port PORT          Port for the spawned mosquitto (default: 18832)"
+    echo "  -r, --rate HZ            Simulator tick rate (default: 1000)"
+    echo "  -d, --duration SECONDS   Measurement duration (default: 10)"
+    echo "  -B, --build-dir DIR      Directory containing the binaries (default: ./build)"
+    echo "  -h, --help               Show this help message"
+}
+
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        -p|--port) MQTT_PORT="$2"; shift 2 ;;
+        -r|--rate) RATE="$2"; shift 2 ;;
+        -d|--duration) DURATION="$2"; shift 2 ;;
+        -B|--build-dir) BUILD_DIR="$2"; shift 2 ;;
+        -h|--help) show_usage; exit 0 ;;
+        *) print_error "Unknown option: $1"; show_usage; exit 1 ;;
+    esac
+done
+
+if ! command -v mosquitto &> /dev/null; then
+    print_error "mosquitto broker not found! Install the mosquitto package."
+    exit 1
+fi
+
+WORK_DIR=$(mktemp -d)
+PIDS=()
+cleanup() {
+    for pid in "${PIDS[@]}"; do kill "$pid" 2>/dev/null || true; done
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+mosquitto -p "$MQTT_PORT" > "$WORK_DIR/broker.log" 2>&1 &
+PIDS+=($!)
+sleep 1
+
+print_status "Simulator at $RATE Hz, measuring for $DURATION s"
+"$BUILD_DIR/sensor_simulator" -b "localhost:$MQTT_PORT" --rate "$RATE" --shm "$SHM_NAME" \
+    > "$WORK_DIR/sim.log" 2>&1 &
+SIM_PID=$!
+PIDS+=($SIM_PID)
+sleep 2
+
+"$BUILD_DIR/sensor_probe" -b "localhost:$MQTT_PORT" -t sensor/all -D "$DURATION" > "$WORK_DIR/mqtt.log" 2>&1 &
+MQTT_PROBE=$!
+"$BUILD_DIR/sensor_probe" --shm "$SHM_NAME" -D "$DURATION" > "$WORK_DIR/shm.log" 2>&1 &
+SHM_PROBE=$!
+wait "$MQTT_PROBE" "$SHM_PROBE" || true
+kill -INT "$SIM_PID" 2>/dev/null || true
+wait "$SIM_PID" 2>/dev/null || true
+
+echo ""
+echo "MQTT loopback (sensor/all):"
+grep -E '^(Topic|sensor/)' "$WORK_DIR/mqtt.log" || cat "$WORK_DIR/mqtt.log"
+echo ""
+echo "Shared memory (/dev/shm/$SHM_NAME):"
+grep -E '^(Topic|shm/)' "$WORK_DIR/shm.log" || cat "$WORK_DIR/shm.log"
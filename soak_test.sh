@@ -0,0 +1,165 @@
+#!/bin/bash
+
+# Soak test for the IMX8MP Sensor Simulator MQTT pipeline
+# Ramps the publish rate against a local mosquitto and uses sensor_probe to
+# measure loss and end-to-end latency at each step, stopping once loss appears.
+
+set -e
+
+# Colors for output
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+# Default values
+MQTT_PORT="18831"
+STEP_DURATION=10
+RATES="100 200 500 1000 2000 5000 10000 20000 50000"
+LOSS_THRESHOLD="0.1"
+BUILD_DIR="./build"
+
+# Function to print colored output
+print_status() {
+    echo -e "${GREEN}[INFO]${NC} $1"
+}
+
+print_warning() {
+    echo -e "${YELLOW}[WARNING]${NC} $1"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR]${NC} $1"
+}
+
+print_test() {
+    echo -e "${BLUE}[TEST]${NC} $1"
+}
+
+# Function to show usage
+show_usage() {
+    echo "Usage: $0 [OPTIONS]"
+    echo ""
+    echo "Options:"
+    echo "  -p, --port PORT          Port for the spawned mosquitto (default: 18831)"
+    echo "  -d, --duration SECONDS   Duration of each rate step (default: 10)"
+    echo "  -r, --rates \"R1 R2 ...\"  Tick rates in Hz to try, ascending"
+    echo "                           (default: \"$RATES\")"
+    echo "  -l, --loss PERCENT       Loss percentage that marks saturation (default: 0.1)"
+    echo "  -B, --build-dir DIR      Directory containing the binaries (default: ./build)"
+    echo "  -h, --help               Show this help message"
+    echo ""
+    echo "Each tick publishes four telemetry messages, so the message rate is 4x the tick rate."
+}
+
+# Parse command line arguments
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        -p|--port)
+            MQTT_PORT="$2"
+            shift 2
+            ;;
+        -d|--duration)
+            STEP_DURATION="$2"
+            shift 2
+            ;;
+        -r|--rates)
+            RATES="$2"
+            shift 2
+            ;;
+        -l|--loss)
+            LOSS_THRESHOLD="$2"
+            shift 2
+            ;;
+        -B|--build-dir)
+            BUILD_DIR="$2"
+            shift 2
+            ;;
+        -h|--help)
+            show_usage
+            exit 0
+            ;;
+        *)
+            print_error "Unknown option: $1"
+            show_usage
+            exit 1
+            ;;
+    esac
+done
+
+for bin in sensor_simulator sensor_probe; do
+    if [[ ! -x "$BUILD_DIR/$bin" ]]; then
+        print_error "$BUILD_DIR/$bin not found! Please build the application first: ./build.sh"
+        exit 1
+    fi
+done
+
+if ! command -v mosquitto &> /dev/null; then
+    print_error "mosquitto broker not found! Install the mosquitto package."
+    exit 1
+fi
+
+WORK_DIR=$(mktemp -d)
+BROKER_PID=""
+
+cleanup() {
+    [[ -n "$BROKER_PID" ]] && kill "$BROKER_PID" 2>/dev/null || true
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+print_status "Starting local mosquitto on port $MQTT_PORT"
+mosquitto -p "$MQTT_PORT" > "$WORK_DIR/broker.log" 2>&1 &
+BROKER_PID=$!
+sleep 1
+if ! kill -0 "$BROKER_PID" 2>/dev/null; then
+    print_error "mosquitto failed to start:"
+    cat "$WORK_DIR/broker.log"
+    exit 1
+fi
+
+printf "%-10s %-10s %-10s %-10s %-10s %-10s %-10s\n" "Rate(Hz)" "Received" "Lost" "Loss%" "p50(us)" "p99(us)" "max(us)"
+
+SATURATION=""
+for RATE in $RATES; do
+    # Probe runs slightly longer than the publisher so the tail is captured
+    "$BUILD_DIR/sensor_probe" -b "localhost:$MQTT_PORT" -D $((STEP_DURATION + 2)) \
+        > "$WORK_DIR/probe_$RATE.log" 2>&1 &
+    PROBE_PID=$!
+    sleep 1
+
+    "$BUILD_DIR/sensor_simulator" -b "localhost:$MQTT_PORT" --rate "$RATE" \
+        -d "soak_$RATE" > "$WORK_DIR/sim_$RATE.log" 2>&1 &
+    SIM_PID=$!
+    sleep "$STEP_DURATION"
+    kill -INT "$SIM_PID" 2>/dev/null || true
+    wait "$SIM_PID" 2>/dev/null || true
+    wait "$PROBE_PID" 2>/dev/null || true
+
+    SUMMARY=$(grep '^SUMMARY' "$WORK_DIR/probe_$RATE.log" || true)
+    if [[ -z "$SUMMARY" ]]; then
+        print_error "No probe summary at $RATE Hz:"
+        cat "$WORK_DIR/probe_$RATE.log"
+        exit 1
+    fi
+
+    field() { echo "$SUMMARY" | tr ' ' '\n' | grep "^$1=" | cut -d= -f2; }
+    LOSS=$(field loss_pct)
+    printf "%-10s %-10s %-10s %-10s %-10s %-10s %-10s\n" "$RATE" "$(field received)" "$(field lost)" \
+        "$LOSS" "$(field p50_us)" "$(field p99_us)" "$(field max_us)"
+
+    if awk -v l="$LOSS" -v t="$LOSS_THRESHOLD" 'BEGIN { exit !(l > t) }'; then
+        SATURATION="$RATE"
+        break
+    fi
+done
+
+echo ""
+if [[ -n "$SATURATION" ]]; then
+    print_test "Loss exceeded ${LOSS_THRESHOLD}% at $SATURATION Hz ($((SATURATION * 4)) msg/s)"
+    print_status "Per-topic breakdown at saturation:"
+    grep -v '^SUMMARY' "$WORK_DIR/probe_$SATURATION.log" | grep -E '^(Topic|sensor/)' || true
+else
+    print_test "No loss above ${LOSS_THRESHOLD}% up to the highest rate tried"
+fi
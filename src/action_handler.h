@@ -7,21 +7,41 @@ class ActionHandler {
 public:
     using HandlerFunc = std::function<std::string(const std::string&)>;
 
+    // Streaming handlers hand partial results to `emit` before returning their
+    // final result; emit returns false when the caller cannot take more
+    using EmitFunc = std::function<bool(const std::string&)>;
+    using StreamingHandlerFunc = std::function<std::string(const std::string&, const EmitFunc&)>;
+
     // Register a handler for a topic
     void register_action_handler(const std::string& topic, HandlerFunc handler) {
         action_handlers_[topic] = handler;
     }
 
+    // Register a handler that streams chunks back to the requester
+    void register_streaming_handler(const std::string& topic, StreamingHandlerFunc handler) {
+        streaming_handlers_[topic] = handler;
+    }
+
     // Run the handler for a topic, returns pair<found, result>
     std::pair<bool, std::string> run_handler(const std::string& topic, const std::string& payload) const {
+        return run_handler(topic, payload, [](const std::string&) { return false; });
+    }
+
+    // As above; chunks from streaming handlers are passed to `emit`
+    std::pair<bool, std::string> run_handler(const std::string& topic, const std::string& payload,
+                                             const EmitFunc& emit) const {
         auto it = action_handlers_.find(topic);
         if (it != action_handlers_.end()) {
             return {true, it->second(payload)};
-        } else {
-            return {false, "No handler for action: " + topic};
         }
+        auto streaming = streaming_handlers_.find(topic);
+        if (streaming != streaming_handlers_.end()) {
+            return {true, streaming->second(payload, emit)};
+        }
+        return {false, "No handler for action: " + topic};
     }
 
 private:
     std::map<std::string, HandlerFunc> action_handlers_;
-}; 
\ No newline at end of file
+    std::map<std::string, StreamingHandlerFunc> streaming_handlers_;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity ring of rows stored column by column: a timestamp column, a
+// sequence column and NumValues double columns.
+//
+// One thread appends; any number of threads scan concurrently without locks.
+// A scan walks contiguous column segments and afterwards re-reads the head to
+// report how many of the scanned rows the writer may have overwritten in the
+// meantime. Readers that keep up (lag < capacity - 1) never see overwrites.
+//
+// Cells are relaxed atomics, so a reader racing the writer gets a stale or new
+// value rather than undefined behaviour; the head works as the sequence word
+// of a seqlock to tell which rows may be mixed.
+template <size_t NumValues>
+class ColumnarRing {
+public:
+    static constexpr size_t kNumValues = NumValues;
+
+    // Contiguous run of rows; column pointers are valid for `count` rows
+    struct Segment {
+        uint64_t first_row;
+        size_t count;
+        const std::atomic<int64_t>* timestamp;
+        const std::atomic<uint64_t>* sequence;
+        std::array<const std::atomic<double>*, NumValues> values;
+
+        int64_t timestampAt(size_t j) const { return timestamp[j].load(std::memory_order_relaxed); }
+        uint64_t sequenceAt(size_t j) const { return sequence[j].load(std::memory_order_relaxed); }
+        double valueAt(size_t k, size_t j) const { return values[k][j].load(std::memory_order_relaxed); }
+    };
+
+    struct ScanResult {
+        uint64_t next_cursor;   // pass to the next scan() to continue
+        uint64_t skipped;       // rows dropped because the reader fell behind
+        uint64_t overwritten;   // leading scanned rows that may be torn
+    };
+
+    explicit ColumnarRing(size_t capacity)
+        : capacity_(roundUpPow2(capacity))
+        , mask_(capacity_ - 1)
+        , timestamp_(capacity_)
+        , sequence_(capacity_)
+        , head_(0)
+    {
+        for (auto& column : values_) {
+            column = std::vector<std::atomic<double>>(capacity_);
+        }
+    }
+
+    // Writer side. Not safe to call from more than one thread.
+    void append(int64_t timestamp, uint64_t sequence, const std::array<double, NumValues>& values) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        size_t i = head & mask_;
+        // Pairs with the reader's acquire fence: a reader that sees any of
+        // these stores also sees head_ >= head and treats row head - capacity
+        // as overwritten
+        std::atomic_thread_fence(std::memory_order_release);
+        timestamp_[i].store(timestamp, std::memory_order_relaxed);
+        sequence_[i].store(sequence, std::memory_order_relaxed);
+        for (size_t k = 0; k < NumValues; k++) {
+            values_[k][i].store(values[k], std::memory_order_relaxed);
+        }
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    // Total rows ever appended
+    uint64_t head() const { return head_.load(std::memory_order_acquire); }
+    size_t capacity() const { return capacity_; }
+
+    // Calls fn(const Segment&) for up to two segments covering [cursor, head)
+    template <typename Fn>
+    ScanResult scan(uint64_t cursor, Fn&& fn) const {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        ScanResult result{head, 0, 0};
+
+        uint64_t oldest = head > capacity_ ? head - capacity_ : 0;
+        if (cursor < oldest) {
+            result.skipped = oldest - cursor;
+            cursor = oldest;
+        }
+
+        for (uint64_t row = cursor; row < head;) {
+            size_t i = row & mask_;
+            size_t count = static_cast<size_t>(std::min<uint64_t>(head - row, capacity_ - i));
+            Segment segment;
+            segment.first_row = row;
+            segment.count = count;
+            segment.timestamp = &timestamp_[i];
+            segment.sequence = &sequence_[i];
+            for (size_t k = 0; k < NumValues; k++) {
+                segment.values[k] = &values_[k][i];
+            }
+            fn(segment);
+            row += count;
+        }
+
+        // Rows up to head - capacity may have been rewritten while fn ran; the
+        // writer may be partway through the slot of row head_after itself
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t head_after = head_.load(std::memory_order_relaxed);
+        uint64_t safe = head_after + 1 > capacity_ ? head_after + 1 - capacity_ : 0;
+        if (safe > cursor) {
+            result.overwritten = std::min(safe, head) - cursor;
+        }
+        return result;
+    }
+
+private:
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::vector<std::atomic<int64_t>> timestamp_;
+    std::vector<std::atomic<uint64_t>> sequence_;
+    std::array<std::vector<std::atomic<double>>, NumValues> values_;
+    alignas(64) std::atomic<uint64_t> head_;
+};
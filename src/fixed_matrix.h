@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Compile-time unrolled loop: calls f(std::integral_constant<size_t, I>) for I in [0, N)
+template <typename F, size_t... I>
+inline void staticForImpl(F&& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+template <size_t N, typename F>
+inline void staticFor(F&& f) {
+    staticForImpl(std::forward<F>(f), std::make_index_sequence<N>{});
+}
+
+// W independent scalars updated element-wise. Using Lane<W> as the scalar
+// type of a Matrix runs W filters in lockstep. Whether that is faster than
+// W scalar filters depends on the target: each Lane temporary lives in
+// memory unless it fits one SIMD register, which for Lane<8> means AVX-512.
+template <size_t W>
+struct alignas(64) Lane {
+    double v[W];
+
+    Lane() = default;
+    Lane(double scalar) {
+        for (size_t i = 0; i < W; i++) v[i] = scalar;
+    }
+
+    double& operator[](size_t i) { return v[i]; }
+    double operator[](size_t i) const { return v[i]; }
+
+#define LANE_OP(op)                                                         \
+    Lane& operator op##=(const Lane& o) {                                   \
+        for (size_t i = 0; i < W; i++) v[i] op##= o.v[i];                   \
+        return *this;                                                       \
+    }                                                                       \
+    friend Lane operator op(const Lane& a, const Lane& b) {                 \
+        Lane r = a;                                                         \
+        return r op##= b;                                                   \
+    }
+    LANE_OP(+)
+    LANE_OP(-)
+    LANE_OP(*)
+    LANE_OP(/)
+#undef LANE_OP
+
+    friend Lane operator-(const Lane& a) {
+        Lane r;
+        for (size_t i = 0; i < W; i++) r.v[i] = -a.v[i];
+        return r;
+    }
+};
+
+template <size_t W>
+inline Lane<W> sqrt(const Lane<W>& a) {
+    Lane<W> r;
+    for (size_t i = 0; i < W; i++) r.v[i] = std::sqrt(a.v[i]);
+    return r;
+}
+
+template <size_t W>
+inline Lane<W> floor(const Lane<W>& a) {
+    Lane<W> r;
+    for (size_t i = 0; i < W; i++) r.v[i] = std::floor(a.v[i]);
+    return r;
+}
+
+// Stack-allocated R x C matrix with compile-time dimensions. All loops are
+// unrolled through staticFor; no operation allocates.
+template <typename T, size_t R, size_t C>
+struct Matrix {
+    T m[R][C];
+
+    static Matrix zero() {
+        Matrix r;
+        staticFor<R>([&](auto i) { staticFor<C>([&](auto j) { r.m[i][j] = T(0.0); }); });
+        return r;
+    }
+
+    static Matrix identity() {
+        static_assert(R == C, "identity requires a square matrix");
+        Matrix r = zero();
+        staticFor<R>([&](auto i) { r.m[i][i] = T(1.0); });
+        return r;
+    }
+
+    T& operator()(size_t i, size_t j) { return m[i][j]; }
+    const T& operator()(size_t i, size_t j) const { return m[i][j]; }
+
+    Matrix<T, C, R> transpose() const {
+        Matrix<T, C, R> r;
+        staticFor<R>([&](auto i) { staticFor<C>([&](auto j) { r.m[j][i] = m[i][j]; }); });
+        return r;
+    }
+
+    Matrix& operator+=(const Matrix& o) {
+        staticFor<R>([&](auto i) { staticFor<C>([&](auto j) { m[i][j] += o.m[i][j]; }); });
+        return *this;
+    }
+
+    Matrix& operator-=(const Matrix& o) {
+        staticFor<R>([&](auto i) { staticFor<C>([&](auto j) { m[i][j] -= o.m[i][j]; }); });
+        return *this;
+    }
+
+    friend Matrix operator+(const Matrix& a, const Matrix& b) {
+        Matrix r = a;
+        return r += b;
+    }
+
+    friend Matrix operator-(const Matrix& a, const Matrix& b) {
+        Matrix r = a;
+        return r -= b;
+    }
+};
+
+template <typename T, size_t R, size_t K, size_t C>
+inline Matrix<T, R, C> operator*(const Matrix<T, R, K>& a, const Matrix<T, K, C>& b) {
+    Matrix<T, R, C> r;
+    staticFor<R>([&](auto i) {
+        staticFor<C>([&](auto j) {
+            T sum = a.m[i][0] * b.m[0][j];
+            staticFor<K - 1>([&](auto k) { sum += a.m[i][k + 1] * b.m[k + 1][j]; });
+            r.m[i][j] = sum;
+        });
+    });
+    return r;
+}
+
+// Closed-form inverses for the innovation covariances used by the filters
+template <typename T>
+inline Matrix<T, 1, 1> inverse(const Matrix<T, 1, 1>& a) {
+    Matrix<T, 1, 1> r;
+    r.m[0][0] = T(1.0) / a.m[0][0];
+    return r;
+}
+
+template <typename T>
+inline Matrix<T, 2, 2> inverse(const Matrix<T, 2, 2>& a) {
+    T inv_det = T(1.0) / (a.m[0][0] * a.m[1][1] - a.m[0][1] * a.m[1][0]);
+    Matrix<T, 2, 2> r;
+    r.m[0][0] = a.m[1][1] * inv_det;
+    r.m[0][1] = -a.m[0][1] * inv_det;
+    r.m[1][0] = -a.m[1][0] * inv_det;
+    r.m[1][1] = a.m[0][0] * inv_det;
+    return r;
+}
+
+// Copies the lanes set in mask from src into dst
+template <size_t W, size_t R, size_t C>
+inline void selectLanes(Matrix<Lane<W>, R, C>& dst, const Matrix<Lane<W>, R, C>& src, uint32_t mask) {
+    staticFor<R>([&](auto i) {
+        staticFor<C>([&](auto j) {
+            for (size_t k = 0; k < W; k++) {
+                if (mask & (1u << k)) dst.m[i][j][k] = src.m[i][j][k];
+            }
+        });
+    });
+}
@@ -0,0 +1,242 @@
+#include "gorilla_codec.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+uint64_t doubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Delta-of-delta buckets: control prefix, payload width and the offset that
+// maps the signed range onto the unsigned payload
+struct DodBucket {
+    uint64_t prefix;
+    int prefix_bits;
+    int value_bits;
+    int64_t min;
+    int64_t max;
+};
+
+constexpr DodBucket kDodBuckets[] = {
+    {0b10, 2, 7, -63, 64},
+    {0b110, 3, 9, -255, 256},
+    {0b1110, 4, 12, -2047, 2048},
+};
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// BitWriter / BitReader
+// ---------------------------------------------------------------------------
+void BitWriter::write(uint64_t value, int bits) {
+    while (bits > 0) {
+        if (free_bits_ == 0) {
+            buffer_.push_back(0);
+            free_bits_ = 8;
+        }
+        int take = std::min(bits, free_bits_);
+        uint8_t chunk = static_cast<uint8_t>((value >> (bits - take)) & ((1u << take) - 1));
+        buffer_.back() = static_cast<char>(static_cast<uint8_t>(buffer_.back()) | (chunk << (free_bits_ - take)));
+        free_bits_ -= take;
+        bits -= take;
+    }
+}
+
+bool BitReader::read(int bits, uint64_t& value) {
+    if (position_ + bits > size_bits_) {
+        return false;
+    }
+    value = 0;
+    while (bits > 0) {
+        size_t byte = position_ / 8;
+        int offset = static_cast<int>(position_ % 8);
+        int take = std::min(bits, 8 - offset);
+        uint8_t chunk = static_cast<uint8_t>(data_[byte] >> (8 - offset - take)) & ((1u << take) - 1);
+        value = (value << take) | chunk;
+        position_ += take;
+        bits -= take;
+    }
+    return true;
+}
+
+bool BitReader::readBit(bool& bit) {
+    uint64_t value;
+    if (!read(1, value)) {
+        return false;
+    }
+    bit = value != 0;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// DeltaOfDeltaEncoder
+// ---------------------------------------------------------------------------
+void DeltaOfDeltaEncoder::reset() {
+    writer_.clear();
+    count_ = 0;
+    previous_ = 0;
+    previous_delta_ = 0;
+}
+
+void DeltaOfDeltaEncoder::append(int64_t value) {
+    if (count_ == 0) {
+        writer_.write(static_cast<uint64_t>(value), 64);
+    } else {
+        int64_t delta = value - previous_;
+        int64_t dod = delta - previous_delta_;
+        previous_delta_ = delta;
+
+        if (dod == 0) {
+            writer_.writeBit(false);
+        } else {
+            bool stored = false;
+            for (const DodBucket& bucket : kDodBuckets) {
+                if (dod >= bucket.min && dod <= bucket.max) {
+                    writer_.write(bucket.prefix, bucket.prefix_bits);
+                    writer_.write(static_cast<uint64_t>(dod - bucket.min), bucket.value_bits);
+                    stored = true;
+                    break;
+                }
+            }
+            if (!stored) {
+                writer_.write(0b1111, 4);
+                writer_.write(static_cast<uint64_t>(dod), 64);
+            }
+        }
+    }
+    previous_ = value;
+    count_++;
+}
+
+bool decodeDeltaOfDelta(const std::string& data, uint32_t count, std::vector<int64_t>& out) {
+    out.clear();
+    out.reserve(count);
+    BitReader reader(data.data(), data.size());
+    int64_t previous = 0;
+    int64_t previous_delta = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t raw;
+        if (i == 0) {
+            if (!reader.read(64, raw)) return false;
+            previous = static_cast<int64_t>(raw);
+            out.push_back(previous);
+            continue;
+        }
+
+        // Count leading one bits of the control prefix (at most four)
+        int ones = 0;
+        bool bit = true;
+        while (ones < 4) {
+            if (!reader.readBit(bit)) return false;
+            if (!bit) break;
+            ones++;
+        }
+
+        int64_t dod;
+        if (ones == 0) {
+            dod = 0;
+        } else if (ones < 4) {
+            const DodBucket& bucket = kDodBuckets[ones - 1];
+            if (!reader.read(bucket.value_bits, raw)) return false;
+            dod = static_cast<int64_t>(raw) + bucket.min;
+        } else {
+            if (!reader.read(64, raw)) return false;
+            dod = static_cast<int64_t>(raw);
+        }
+
+        previous_delta += dod;
+        previous += previous_delta;
+        out.push_back(previous);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// XorEncoder
+// ---------------------------------------------------------------------------
+void XorEncoder::reset() {
+    writer_.clear();
+    count_ = 0;
+    previous_ = 0;
+    leading_ = -1;
+    trailing_ = 0;
+}
+
+void XorEncoder::append(double value) {
+    uint64_t bits = doubleBits(value);
+    if (count_ == 0) {
+        writer_.write(bits, 64);
+    } else {
+        uint64_t x = bits ^ previous_;
+        if (x == 0) {
+            writer_.writeBit(false);
+        } else {
+            writer_.writeBit(true);
+            int leading = std::min(__builtin_clzll(x), 31);
+            int trailing = __builtin_ctzll(x);
+
+            if (leading_ >= 0 && leading >= leading_ && trailing >= trailing_) {
+                // Fits the previous window
+                writer_.writeBit(false);
+                writer_.write(x >> trailing_, 64 - leading_ - trailing_);
+            } else {
+                int meaningful = 64 - leading - trailing;
+                writer_.writeBit(true);
+                writer_.write(static_cast<uint64_t>(leading), 5);
+                writer_.write(static_cast<uint64_t>(meaningful - 1), 6);
+                writer_.write(x >> trailing, meaningful);
+                leading_ = leading;
+                trailing_ = trailing;
+            }
+        }
+    }
+    previous_ = bits;
+    count_++;
+}
+
+bool decodeXor(const std::string& data, uint32_t count, std::vector<double>& out) {
+    out.clear();
+    out.reserve(count);
+    BitReader reader(data.data(), data.size());
+    uint64_t previous = 0;
+    int leading = -1;
+    int trailing = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t raw;
+        if (i == 0) {
+            if (!reader.read(64, previous)) return false;
+            out.push_back(bitsDouble(previous));
+            continue;
+        }
+
+        bool changed, new_window;
+        if (!reader.readBit(changed)) return false;
+        if (changed) {
+            if (!reader.readBit(new_window)) return false;
+            if (new_window) {
+                uint64_t lz, length;
+                if (!reader.read(5, lz) || !reader.read(6, length)) return false;
+                leading = static_cast<int>(lz);
+                trailing = 64 - leading - static_cast<int>(length + 1);
+                if (trailing < 0) return false;
+            } else if (leading < 0) {
+                return false;
+            }
+            if (!reader.read(64 - leading - trailing, raw)) return false;
+            previous ^= raw << trailing;
+        }
+        out.push_back(bitsDouble(previous));
+    }
+    return true;
+}
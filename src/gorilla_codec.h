@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Time-series column codecs after Facebook's Gorilla paper:
+// delta-of-delta for integer timestamps and counters, XOR with the previous
+// value for doubles. Both are bit-packed MSB first into a std::string so the
+// result can go straight into a protobuf bytes field.
+
+class BitWriter {
+public:
+    BitWriter() : free_bits_(0) {}
+
+    void write(uint64_t value, int bits);
+    void writeBit(bool bit) { write(bit ? 1 : 0, 1); }
+
+    const std::string& bytes() const { return buffer_; }
+    size_t sizeBits() const { return buffer_.size() * 8 - free_bits_; }
+    void clear() { buffer_.clear(); free_bits_ = 0; }
+
+private:
+    std::string buffer_;
+    int free_bits_;  // unused low bits in the last byte
+};
+
+class BitReader {
+public:
+    BitReader(const void* data, size_t size)
+        : data_(static_cast<const uint8_t*>(data)), size_bits_(size * 8), position_(0) {}
+
+    // False once the input is exhausted
+    bool read(int bits, uint64_t& value);
+    bool readBit(bool& bit);
+
+private:
+    const uint8_t* data_;
+    size_t size_bits_;
+    size_t position_;
+};
+
+// Delta-of-delta: regular series cost one bit per value
+class DeltaOfDeltaEncoder {
+public:
+    DeltaOfDeltaEncoder() { reset(); }
+
+    void append(int64_t value);
+    void reset();
+
+    const std::string& bytes() const { return writer_.bytes(); }
+    uint32_t count() const { return count_; }
+
+private:
+    BitWriter writer_;
+    uint32_t count_;
+    int64_t previous_;
+    int64_t previous_delta_;
+};
+
+// XOR: unchanged values cost one bit, small changes reuse the previous
+// leading/trailing zero window
+class XorEncoder {
+public:
+    XorEncoder() { reset(); }
+
+    void append(double value);
+    void reset();
+
+    const std::string& bytes() const { return writer_.bytes(); }
+    uint32_t count() const { return count_; }
+
+private:
+    BitWriter writer_;
+    uint32_t count_;
+    uint64_t previous_;
+    int leading_;   // window of the last stored XOR; -1 before the first
+    int trailing_;
+};
+
+// Decode `count` values; false if the data is truncated or malformed
+bool decodeDeltaOfDelta(const std::string& data, uint32_t count, std::vector<int64_t>& out);
+bool decodeXor(const std::string& data, uint32_t count, std::vector<double>& out);
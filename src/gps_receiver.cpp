@@ -0,0 +1,191 @@
+#include "gps_receiver.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kReadBufferBytes = 4096;
+constexpr int kReopenIntervalMs = 1000;
+
+// Bytes arriving within this window after a wakeup are read together, which
+// bounds the wakeup rate when the UART driver delivers a sentence piecemeal
+constexpr int kBatchDelayMs = 5;
+
+speed_t baudConstant(int baud) {
+    switch (baud) {
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+    }
+    return B0;
+}
+
+} // namespace
+
+GpsReceiver::GpsReceiver(const std::string& device, int baud, double uere_m)
+    : device_(device)
+    , baud_(baud)
+    , fd_(-1)
+    , wake_fd_(-1)
+    , running_(false)
+    , parser_(uere_m)
+    , has_fix_(false)
+{
+}
+
+GpsReceiver::~GpsReceiver() {
+    stop();
+}
+
+bool GpsReceiver::openDevice() {
+    fd_ = open(device_.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    // Raw 8N1 at the requested speed. Non-ttys (FIFOs) are read as they are.
+    termios tio;
+    if (tcgetattr(fd_, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        speed_t speed = baudConstant(baud_);
+        if (speed != B0) {
+            cfsetispeed(&tio, speed);
+            cfsetospeed(&tio, speed);
+        }
+        if (tcsetattr(fd_, TCSANOW, &tio) != 0) {
+            std::cerr << "Failed to configure " << device_ << ": " << std::strerror(errno) << std::endl;
+        }
+        tcflush(fd_, TCIFLUSH);
+    }
+    return true;
+}
+
+void GpsReceiver::closeDevice() {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool GpsReceiver::start() {
+    if (running_) {
+        return true;
+    }
+    if (baudConstant(baud_) == B0) {
+        std::cerr << "Unsupported GPS baud rate: " << baud_ << std::endl;
+        return false;
+    }
+    if (!openDevice()) {
+        std::cerr << "Failed to open GPS device " << device_ << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        std::cerr << "Failed to create eventfd: " << std::strerror(errno) << std::endl;
+        closeDevice();
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&GpsReceiver::run, this);
+    return true;
+}
+
+void GpsReceiver::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+        // The reader still notices running_ within its poll timeout
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closeDevice();
+    close(wake_fd_);
+    wake_fd_ = -1;
+}
+
+bool GpsReceiver::latest(GpsFix& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!has_fix_) {
+        return false;
+    }
+    out = fix_;
+    return true;
+}
+
+NmeaStats GpsReceiver::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void GpsReceiver::run() {
+    char buffer[kReadBufferBytes];
+
+    while (running_) {
+        if (fd_ < 0) {
+            pollfd wake{wake_fd_, POLLIN, 0};
+            poll(&wake, 1, kReopenIntervalMs);
+            if (running_ && openDevice()) {
+                std::cout << "[GPS] Reopened " << device_ << std::endl;
+            }
+            continue;
+        }
+
+        pollfd fds[2] = {{fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        if (poll(fds, 2, kReopenIntervalMs) <= 0 || !running_) {
+            continue;
+        }
+        if (fds[0].revents & POLLIN) {
+            poll(&fds[1], 1, kBatchDelayMs);
+        }
+
+        // Drain everything that has arrived. A raw tty returns 0 rather than
+        // EAGAIN when empty, so hangups are taken from poll() and EIO instead.
+        size_t updates = 0;
+        bool lost = (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+        while (true) {
+            ssize_t n = read(fd_, buffer, sizeof(buffer));
+            if (n > 0) {
+                updates += parser_.feed(buffer, static_cast<size_t>(n));
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                lost = lost || (n < 0 && errno != EAGAIN);
+                break;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_ = parser_.stats();
+            if (updates > 0 || has_fix_) {
+                fix_ = parser_.fix();
+                has_fix_ = true;
+            }
+        }
+
+        if (lost) {
+            std::cerr << "[GPS] Lost " << device_ << ", retrying" << std::endl;
+            closeDevice();
+        }
+    }
+}
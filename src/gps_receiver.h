@@ -0,0 +1,45 @@
+#pragma once
+
+#include "nmea_parser.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// NMEA GNSS receiver on a serial port or pseudo-terminal.
+//
+// A background thread sleeps in poll() on the non-blocking tty, drains
+// whatever has arrived into a fixed buffer and feeds it to NmeaParser, so a
+// 10 Hz receiver costs a few wakeups per fix. If the device goes away the
+// thread retries opening it once per second.
+class GpsReceiver {
+public:
+    GpsReceiver(const std::string& device, int baud = 115200, double uere_m = 4.0);
+    ~GpsReceiver();
+
+    // Opens and configures the device and starts the reader thread
+    bool start();
+    void stop();
+
+    // Latest position; false until the receiver has reported a fix
+    bool latest(GpsFix& out) const;
+    NmeaStats stats() const;
+
+private:
+    bool openDevice();
+    void closeDevice();
+    void run();
+
+    std::string device_;
+    int baud_;
+    int fd_;
+    int wake_fd_;  // eventfd that interrupts poll() on stop()
+    std::atomic<bool> running_;
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    NmeaParser parser_;  // reader thread only
+    GpsFix fix_;         // guarded by mutex_
+    NmeaStats stats_;    // guarded by mutex_
+    bool has_fix_;       // guarded by mutex_
+};
@@ -0,0 +1,358 @@
+#include "history_store.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t kSpillMagic = 0x48495354;  // "HIST"
+
+// Spill record header; the timestamp, sequence and value columns follow
+struct SpillHeader {
+    uint32_t magic;
+    uint32_t count;
+    int64_t start_ms;
+    int64_t end_ms;
+    uint32_t lengths[2 + kHistoryColumnCount];
+};
+
+double quantize(double value, double step) {
+    return step > 0.0 ? std::round(value / step) * step : value;
+}
+
+// Power-of-two step closest to `step` from below, so quantized values keep
+// their low mantissa bits zero
+double powerOfTwoStep(double step) {
+    if (step <= 0.0) {
+        return 0.0;
+    }
+    return std::ldexp(1.0, static_cast<int>(std::floor(std::log2(step))));
+}
+
+} // namespace
+
+const char* historyColumnName(int column) {
+    switch (column) {
+        case kHistoryTemperature: return "temperature";
+        case kHistoryHeading: return "heading";
+        case kHistoryLatitude: return "latitude";
+        case kHistoryLongitude: return "longitude";
+        case kHistoryAltitude: return "altitude";
+        case kHistoryAccuracy: return "accuracy";
+    }
+    return "unknown";
+}
+
+size_t EncodedBlock::compressedBytes() const {
+    size_t bytes = timestamps.size() + sequences.size();
+    for (const auto& column : columns) {
+        bytes += column.size();
+    }
+    return bytes;
+}
+
+// ---------------------------------------------------------------------------
+// HistoryQuery
+// ---------------------------------------------------------------------------
+bool HistoryQuery::parse(const std::string& payload, int64_t now_ms, HistoryQuery& out, std::string& error) {
+    out = HistoryQuery();
+    std::istringstream tokens(payload);
+    std::string token;
+    while (tokens >> token) {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos) {
+            error = "Expected key=value, got '" + token + "'";
+            return false;
+        }
+        std::string key = token.substr(0, eq);
+        std::string value = token.substr(eq + 1);
+        try {
+            if (key == "from") {
+                out.from_ms = std::stoll(value);
+            } else if (key == "to") {
+                out.to_ms = std::stoll(value);
+            } else if (key == "max_bytes") {
+                out.max_bytes = std::stoull(value);
+            } else if (key == "channels") {
+                out.column_mask = 0;
+                std::istringstream names(value);
+                std::string name;
+                while (std::getline(names, name, ',')) {
+                    if (name == "all") {
+                        out.column_mask = (1u << kHistoryColumnCount) - 1;
+                    } else if (name == "compass") {
+                        out.column_mask |= 1u << kHistoryHeading;
+                    } else if (name == "gps") {
+                        out.column_mask |= (1u << kHistoryLatitude) | (1u << kHistoryLongitude) |
+                                           (1u << kHistoryAltitude) | (1u << kHistoryAccuracy);
+                    } else {
+                        int column = 0;
+                        while (column < kHistoryColumnCount && name != historyColumnName(column)) {
+                            column++;
+                        }
+                        if (column == kHistoryColumnCount) {
+                            error = "Unknown channel '" + name + "'";
+                            return false;
+                        }
+                        out.column_mask |= 1u << column;
+                    }
+                }
+            } else {
+                error = "Unknown key '" + key + "'";
+                return false;
+            }
+        } catch (const std::exception&) {
+            error = "Invalid value for '" + key + "'";
+            return false;
+        }
+    }
+
+    if (out.from_ms <= 0) out.from_ms += now_ms;
+    if (out.to_ms <= 0) out.to_ms += now_ms;
+    if (out.from_ms > out.to_ms) {
+        error = "from is after to";
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// HistoryStore
+// ---------------------------------------------------------------------------
+HistoryStore::HistoryStore(const HistoryStoreConfig& config)
+    : config_(config)
+    , open_start_ms_(0)
+    , open_end_ms_(0)
+    , memory_used_(0)
+    , spill_fd_(-1)
+    , spill_offset_(0)
+    , spill_serial_(0)
+{
+    for (double& step : config_.resolution) {
+        step = powerOfTwoStep(step);
+    }
+    if (config_.block_samples == 0) {
+        config_.block_samples = 1;
+    }
+}
+
+HistoryStore::~HistoryStore() {
+    if (spill_fd_ >= 0) {
+        close(spill_fd_);
+    }
+}
+
+bool HistoryStore::open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (config_.spill_path.empty()) {
+        return true;
+    }
+    spill_fd_ = ::open(config_.spill_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (spill_fd_ < 0) {
+        std::cerr << "Failed to open history file " << config_.spill_path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void HistoryStore::append(const SensorData& data) {
+    int64_t timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        data.timestamp.time_since_epoch()).count();
+    const double values[kHistoryColumnCount] = {
+        data.cpu_temperature, data.compass_heading, data.gps_latitude,
+        data.gps_longitude, data.gps_altitude, data.gps_accuracy,
+    };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timestamps_.count() == 0) {
+        open_start_ms_ = timestamp_ms;
+    }
+    open_end_ms_ = timestamp_ms;
+    timestamps_.append(timestamp_ms);
+    sequences_.append(static_cast<int64_t>(data.sequence));
+    for (int c = 0; c < kHistoryColumnCount; c++) {
+        columns_[c].append(quantize(values[c], config_.resolution[c]));
+    }
+    stats_.samples++;
+
+    if (timestamps_.count() >= config_.block_samples) {
+        sealLocked();
+    }
+}
+
+EncodedBlock HistoryStore::openBlockLocked() const {
+    EncodedBlock block;
+    block.start_ms = open_start_ms_;
+    block.end_ms = open_end_ms_;
+    block.count = timestamps_.count();
+    block.timestamps = timestamps_.bytes();
+    block.sequences = sequences_.bytes();
+    for (int c = 0; c < kHistoryColumnCount; c++) {
+        block.columns[c] = columns_[c].bytes();
+    }
+    return block;
+}
+
+void HistoryStore::sealLocked() {
+    EncodedBlock block = openBlockLocked();
+    timestamps_.reset();
+    sequences_.reset();
+    for (auto& column : columns_) {
+        column.reset();
+    }
+
+    stats_.raw_bytes += block.rawBytes();
+    stats_.compressed_bytes += block.compressedBytes();
+
+    memory_used_ += block.compressedBytes();
+    memory_.push_back(std::move(block));
+    while (memory_used_ > config_.memory_bytes && memory_.size() > 1) {
+        spillLocked(memory_.front());
+        memory_used_ -= memory_.front().compressedBytes();
+        memory_.pop_front();
+    }
+}
+
+void HistoryStore::spillLocked(const EncodedBlock& block) {
+    if (spill_fd_ < 0) {
+        return;
+    }
+
+    SpillHeader header{};
+    header.magic = kSpillMagic;
+    header.count = block.count;
+    header.start_ms = block.start_ms;
+    header.end_ms = block.end_ms;
+    header.lengths[0] = static_cast<uint32_t>(block.timestamps.size());
+    header.lengths[1] = static_cast<uint32_t>(block.sequences.size());
+    for (int c = 0; c < kHistoryColumnCount; c++) {
+        header.lengths[2 + c] = static_cast<uint32_t>(block.columns[c].size());
+    }
+
+    std::string record(reinterpret_cast<const char*>(&header), sizeof(header));
+    record += block.timestamps;
+    record += block.sequences;
+    for (const auto& column : block.columns) {
+        record += column;
+    }
+    if (record.size() > config_.spill_bytes) {
+        return;
+    }
+
+    // Wrap to the start of the file once the cap would be exceeded. The
+    // records between the write position and the end of the file are dropped
+    // with the wrap, so the index always runs in file order from the write
+    // position and every record a write overlaps is at its front.
+    if (spill_offset_ + record.size() > config_.spill_bytes) {
+        while (!spilled_.empty() && spilled_.front().offset >= spill_offset_) {
+            spilled_.pop_front();
+        }
+        spill_offset_ = 0;
+    }
+    uint64_t begin = spill_offset_;
+    uint64_t end = begin + record.size();
+
+    // Drop the oldest records this write overlaps
+    while (!spilled_.empty() &&
+           spilled_.front().offset < end && spilled_.front().offset + spilled_.front().length > begin) {
+        spilled_.pop_front();
+    }
+
+    if (pwrite(spill_fd_, record.data(), record.size(), static_cast<off_t>(begin)) != static_cast<ssize_t>(record.size())) {
+        std::cerr << "Failed to write history file: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    spilled_.push_back({block.start_ms, block.end_ms, begin, static_cast<uint32_t>(record.size()), spill_serial_++});
+    spill_offset_ = end;
+}
+
+bool HistoryStore::readSpilled(const SpillEntry& entry, EncodedBlock& out) const {
+    std::string record(entry.length, '\0');
+    if (pread(spill_fd_, &record[0], entry.length, static_cast<off_t>(entry.offset)) != static_cast<ssize_t>(entry.length)) {
+        return false;
+    }
+
+    SpillHeader header;
+    std::memcpy(&header, record.data(), sizeof(header));
+    if (header.magic != kSpillMagic) {
+        return false;
+    }
+
+    out.start_ms = header.start_ms;
+    out.end_ms = header.end_ms;
+    out.count = header.count;
+    size_t offset = sizeof(header);
+    std::string* sections[2 + kHistoryColumnCount] = {&out.timestamps, &out.sequences};
+    for (int c = 0; c < kHistoryColumnCount; c++) {
+        sections[2 + c] = &out.columns[c];
+    }
+    for (int i = 0; i < 2 + kHistoryColumnCount; i++) {
+        if (offset + header.lengths[i] > record.size()) {
+            return false;
+        }
+        sections[i]->assign(record, offset, header.lengths[i]);
+        offset += header.lengths[i];
+    }
+    return true;
+}
+
+bool HistoryStore::spillEntryLive(const SpillEntry& entry) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Serials are consecutive in the index, so the entry can only be at one place
+    if (spilled_.empty() || entry.serial < spilled_.front().serial) {
+        return false;
+    }
+    uint64_t index = entry.serial - spilled_.front().serial;
+    return index < spilled_.size() && spilled_[index].serial == entry.serial &&
+           spilled_[index].offset == entry.offset && spilled_[index].length == entry.length;
+}
+
+size_t HistoryStore::query(int64_t from_ms, int64_t to_ms, const std::function<bool(const EncodedBlock&)>& fn) const {
+    auto overlaps = [from_ms, to_ms](int64_t start, int64_t end) {
+        return start <= to_ms && end >= from_ms;
+    };
+
+    // Copy what overlaps, then read and call back without blocking append()
+    std::vector<SpillEntry> spilled;
+    std::vector<EncodedBlock> blocks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const SpillEntry& entry : spilled_) {
+            if (overlaps(entry.start_ms, entry.end_ms)) spilled.push_back(entry);
+        }
+        for (const EncodedBlock& block : memory_) {
+            if (overlaps(block.start_ms, block.end_ms)) blocks.push_back(block);
+        }
+        if (timestamps_.count() > 0 && overlaps(open_start_ms_, open_end_ms_)) {
+            blocks.push_back(openBlockLocked());
+        }
+    }
+
+    size_t visited = 0;
+    for (const SpillEntry& entry : spilled) {
+        // Entries are dropped before their bytes are overwritten, so one that
+        // is still indexed after the read was read intact
+        EncodedBlock block;
+        if (!readSpilled(entry, block) || !spillEntryLive(entry)) continue;
+        visited++;
+        if (!fn(block)) return visited;
+    }
+
+    for (const EncodedBlock& block : blocks) {
+        visited++;
+        if (!fn(block)) return visited;
+    }
+    return visited;
+}
+
+HistoryStore::Stats HistoryStore::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.memory_blocks = memory_.size();
+    stats.spilled_blocks = spilled_.size();
+    return stats;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "gorilla_codec.h"
+#include "sensor_simulator.h"
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// Value columns kept by the history store
+enum HistoryColumnId {
+    kHistoryTemperature = 0,
+    kHistoryHeading,
+    kHistoryLatitude,
+    kHistoryLongitude,
+    kHistoryAltitude,
+    kHistoryAccuracy,
+    kHistoryColumnCount
+};
+
+const char* historyColumnName(int column);
+
+// One compressed block: timestamps and sequences as delta-of-delta, every
+// value column as Gorilla XOR. Columns decode independently.
+struct EncodedBlock {
+    int64_t start_ms = 0;     // first sample, Unix milliseconds
+    int64_t end_ms = 0;       // last sample, Unix milliseconds
+    uint32_t count = 0;
+    std::string timestamps;
+    std::string sequences;
+    std::array<std::string, kHistoryColumnCount> columns;
+
+    size_t compressedBytes() const;
+    size_t rawBytes() const { return count * (2 + kHistoryColumnCount) * sizeof(uint64_t); }
+};
+
+struct HistoryStoreConfig {
+    size_t memory_bytes = 1024 * 1024;  // compressed blocks kept in memory
+    uint32_t block_samples = 1024;      // samples per block
+    std::string spill_path;             // evicted blocks go here when set
+    uint64_t spill_bytes = 32ull * 1024 * 1024;  // file is reused as a ring beyond this size
+
+    // Values are rounded to these power-of-two steps before encoding (0 keeps
+    // them exact). Sensor noise below the step otherwise fills the mantissa
+    // and defeats the XOR coding. Defaults are well under sensor accuracy.
+    std::array<double, kHistoryColumnCount> resolution = {
+        1.0 / 64,        // temperature, Celsius
+        1.0 / 64,        // heading, degrees
+        1.0 / 1048576,   // latitude, degrees (~0.1 m)
+        1.0 / 1048576,   // longitude, degrees
+        1.0 / 16,        // altitude, meters
+        1.0 / 16,        // accuracy, meters
+    };
+};
+
+// Parsed 'history' action payload: "from=<ms> to=<ms> channels=<list> max_bytes=<n>".
+// from/to are Unix milliseconds; zero or negative values are relative to now.
+// Channels are column names or the groups temperature, compass, gps and all.
+struct HistoryQuery {
+    int64_t from_ms = -3600 * 1000;
+    int64_t to_ms = 0;
+    uint32_t column_mask = (1u << kHistoryColumnCount) - 1;
+    size_t max_bytes = 1024 * 1024;  // response budget; later blocks are left out
+
+    static bool parse(const std::string& payload, int64_t now_ms, HistoryQuery& out, std::string& error);
+};
+
+// Local history of SensorData in compressed columnar blocks.
+//
+// Samples go into an open block; full blocks are sealed into a memory ring of
+// at most memory_bytes. Blocks evicted from the ring are appended to the spill
+// file, which wraps to its start once spill_bytes would be exceeded, dropping
+// the oldest spilled blocks. The spill index lives in memory, so the file is
+// truncated on open(). Thread-safe: the sampling thread appends while action
+// handlers query. A query holds the lock only to copy the overlapping blocks
+// and spill index; file reads and the callback run unlocked.
+class HistoryStore {
+public:
+    struct Stats {
+        uint64_t samples = 0;
+        uint64_t raw_bytes = 0;
+        uint64_t compressed_bytes = 0;
+        size_t memory_blocks = 0;
+        size_t spilled_blocks = 0;
+    };
+
+    explicit HistoryStore(const HistoryStoreConfig& config = HistoryStoreConfig());
+    ~HistoryStore();
+
+    // Opens the spill file when configured
+    bool open();
+
+    void append(const SensorData& data);
+
+    // Calls fn for every block overlapping [from_ms, to_ms], oldest first,
+    // including the open block. Stops when fn returns false. Spilled blocks
+    // overwritten by the file wrapping during the query are skipped. Returns
+    // the number of blocks visited.
+    size_t query(int64_t from_ms, int64_t to_ms, const std::function<bool(const EncodedBlock&)>& fn) const;
+
+    Stats stats() const;
+
+private:
+    struct SpillEntry {
+        int64_t start_ms;
+        int64_t end_ms;
+        uint64_t offset;
+        uint32_t length;
+        uint64_t serial;  // spill order, consecutive across the index
+    };
+
+    void sealLocked();
+    void spillLocked(const EncodedBlock& block);
+    bool readSpilled(const SpillEntry& entry, EncodedBlock& out) const;
+    bool spillEntryLive(const SpillEntry& entry) const;
+    EncodedBlock openBlockLocked() const;
+
+    HistoryStoreConfig config_;
+    mutable std::mutex mutex_;
+
+    // Open block
+    DeltaOfDeltaEncoder timestamps_;
+    DeltaOfDeltaEncoder sequences_;
+    std::array<XorEncoder, kHistoryColumnCount> columns_;
+    int64_t open_start_ms_;
+    int64_t open_end_ms_;
+
+    // Sealed blocks
+    std::deque<EncodedBlock> memory_;
+    size_t memory_used_;
+
+    // Spill file
+    int spill_fd_;
+    uint64_t spill_offset_;
+    uint64_t spill_serial_;
+    std::deque<SpillEntry> spilled_;
+
+    Stats stats_;
+};
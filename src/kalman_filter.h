@@ -0,0 +1,31 @@
+#pragma once
+
+#include "fixed_matrix.h"
+
+// Linear Kalman filter with NX states and NZ measurements. T is double for a
+// single filter or Lane<W> to run W independent filters in one pass.
+template <typename T, size_t NX, size_t NZ>
+struct KalmanFilter {
+    using State = Matrix<T, NX, 1>;
+    using Covariance = Matrix<T, NX, NX>;
+    using Measurement = Matrix<T, NZ, 1>;
+    using Observation = Matrix<T, NZ, NX>;
+    using MeasurementNoise = Matrix<T, NZ, NZ>;
+
+    State x;
+    Covariance P;
+
+    void predict(const Covariance& F, const Covariance& Q) {
+        x = F * x;
+        P = F * P * F.transpose() + Q;
+    }
+
+    // The innovation (z - Hx) is passed in so callers can wrap angular states
+    void update(const Measurement& innovation, const Observation& H, const MeasurementNoise& R) {
+        Matrix<T, NX, NZ> PHt = P * H.transpose();
+        Matrix<T, NZ, NZ> S = H * PHt + R;
+        Matrix<T, NX, NZ> K = PHt * inverse(S);
+        x += K * innovation;
+        P = (Covariance::identity() - K * H) * P;
+    }
+};
@@ -3,6 +3,8 @@
 #include <chrono>
 #include <signal.h>
 #include <cstring>
+#include <algorithm>
+#include <memory>
 #include "sensor_simulator.h"
 #include "mqtt_client.h"
 #include "protobuf_converter.h"
@@ -10,6 +12,14 @@
 #include <map>
 #include <functional>
 #include "action_handler.h"
+#include "sensor_aggregator.h"
+#include "sensor_fusion.h"
+#include "shm_ring.h"
+#include "rate_governor.h"
+#include "rt_sampler.h"
+#include "history_store.h"
+#include "gps_receiver.h"
+#include "status_template.h"
 
 // Global variables for signal handling
 volatile bool running = true;
@@ -38,6 +48,11 @@ auto handle_action_message = [](const std::string& payload) -> std::string {
     return "Status: OK";
 };
 
+// Handler for 'ping' action: echoes the payload so callers can time the ack round trip
+auto handle_action_ping = [](const std::string& payload) -> std::string {
+    return payload;
+};
+
 // Signal handler for graceful shutdown
 void signalHandler(int signum) {
     std::cout << "\nReceived signal " << signum << ". Shutting down gracefully..." << std::endl;
@@ -53,6 +68,7 @@ void printUsage(const char* program_name) {
               << "Options:\n"
               << "  -b, --broker HOST[:PORT]    MQTT broker address (default: localhost:1883)\n"
               << "  -i, --interval MS           Update interval in milliseconds (default: 1000)\n"
+              << "  -r, --rate HZ               Update rate in Hz, overrides --interval (for soak tests)\n"
               << "  -t, --temp-min TEMP         Minimum CPU temperature in Celsius (default: 35.0)\n"
               << "  -T, --temp-max TEMP         Maximum CPU temperature in Celsius (default: 85.0)\n"
               << "  -c, --compass-var DEG       Compass variation in degrees (default: 5.0)\n"
@@ -60,12 +76,39 @@ void printUsage(const char* program_name) {
               << "  -u, --username USER         MQTT username\n"
               << "  -p, --password PASS         MQTT password\n"
               << "  -d, --client-id ID          MQTT client ID (default: sensor_simulator)\n"
+              << "  -A, --agg-window SEC        Publish windowed aggregates on sensor/agg (default: off)\n"
+              << "  -S, --agg-slide SEC         Sliding window step; equal to the window for tumbling (default: window)\n"
+              << "      --no-raw                Do not publish raw samples (use with --agg-window)\n"
+              << "  -F, --fusion                Kalman-filter GPS position and compass heading before publishing\n"
+              << "  -s, --shm NAME              Also write samples to the /dev/shm/NAME ring for local readers\n"
+              << "      --shm-history N         History slots in the shared-memory ring (default: 1024)\n"
+              << "  -G, --governor              Degrade publishing to stay within the cgroup CPU/memory budget\n"
+              << "      --cpu-budget PCT        CPU budget in percent of one core (default: cgroup cpu.max)\n"
+              << "      --mem-budget MB         Memory budget in MiB (default: cgroup memory.max)\n"
+              << "      --rt                    Sample on a dedicated SCHED_FIFO thread with locked memory\n"
+              << "      --rt-priority PRIO      SCHED_FIFO priority of the sampling thread (default: 50)\n"
+              << "      --rt-cpu CPU            Pin the sampling thread to CPU (default: unpinned)\n"
+              << "      --rt-report SEC         Tick jitter report interval, 0 to disable (default: 10)\n"
+              << "      --no-lanes              Publish without priority lanes (for comparison)\n"
+              << "      --lane-scheduling MODE  strict or weighted scheduling between lanes (default: strict)\n"
+              << "      --lane-window N         Packets handed to libmosquitto ahead of the lanes (default: 16)\n"
+              << "      --heartbeat SEC         Publish a heartbeat status on sensor/heartbeat/ID every SEC (default: off)\n"
+              << "      --heartbeat-devices N   Also publish heartbeats for N simulated devices (default: 0)\n"
+              << "      --no-batch              Do not coalesce a tick's messages into shared TCP segments\n"
+              << "      --tcp-nodelay           Disable Nagle on the broker connection (default: Nagle on)\n"
+              << "      --history-memory KB     Compressed sample history kept in memory (default: 1024)\n"
+              << "      --history-file PATH     Spill history evicted from memory to PATH (default: off)\n"
+              << "      --history-file-size MB  Size cap of the history file (default: 32)\n"
+              << "      --no-history            Do not keep sample history for the 'history' action\n"
+              << "      --gps-device PATH       Read positions from an NMEA receiver on PATH instead of simulating\n"
+              << "      --gps-baud BAUD         Baud rate of the GPS receiver (default: 115200)\n"
               << "  -h, --help                  Show this help message\n"
               << "\nMQTT Topics (Protocol Buffers):\n"
               << "  sensor/temperature           CPU temperature data (protobuf)\n"
               << "  sensor/compass              Compass heading data (protobuf)\n"
               << "  sensor/gps                  GPS position data (protobuf)\n"
               << "  sensor/all                  All sensor data combined (protobuf)\n"
+              << "  sensor/agg                  Windowed aggregates (protobuf, with --agg-window)\n"
               << "  sensor/status               Device status (protobuf)\n"
               << std::endl;
 }
@@ -75,6 +118,7 @@ int main(int argc, char* argv[]) {
     std::string broker = "localhost";
     int port = 1883;
     int interval_ms = 1000;
+    double rate_hz = 0.0;
     double temp_min = 35.0;
     double temp_max = 85.0;
     double compass_var = 5.0;
@@ -82,6 +126,28 @@ int main(int argc, char* argv[]) {
     std::string username;
     std::string password;
     std::string client_id = "sensor_simulator";
+    double agg_window_s = 0.0;
+    double agg_slide_s = 0.0;
+    bool publish_raw = true;
+    bool fusion_enabled = false;
+    std::string shm_name;
+    size_t shm_history = 1024;
+    bool governor_enabled = false;
+    GovernorConfig governor_config;
+    bool rt_enabled = false;
+    RtConfig rt_config;
+    int rt_report_s = 10;
+    bool lanes_enabled = true;
+    MqttClient::LaneScheduling lane_scheduling = MqttClient::kStrict;
+    size_t lane_window = 16;
+    bool batch_publish = true;
+    bool tcp_nodelay = false;
+    double heartbeat_s = 0.0;
+    size_t heartbeat_devices = 0;
+    bool history_enabled = true;
+    HistoryStoreConfig history_config;
+    std::string gps_device;
+    int gps_baud = 115200;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -103,6 +169,8 @@ int main(int argc, char* argv[]) {
             }
         } else if (arg == "-i" || arg == "--interval") {
             if (++i < argc) interval_ms = std::stoi(argv[i]);
+        } else if (arg == "-r" || arg == "--rate") {
+            if (++i < argc) rate_hz = std::stod(argv[i]);
         } else if (arg == "-t" || arg == "--temp-min") {
             if (++i < argc) temp_min = std::stod(argv[i]);
         } else if (arg == "-T" || arg == "--temp-max") {
@@ -117,6 +185,66 @@ int main(int argc, char* argv[]) {
             if (++i < argc) password = argv[i];
         } else if (arg == "-d" || arg == "--client-id") {
             if (++i < argc) client_id = argv[i];
+        } else if (arg == "-A" || arg == "--agg-window") {
+            if (++i < argc) agg_window_s = std::stod(argv[i]);
+        } else if (arg == "-S" || arg == "--agg-slide") {
+            if (++i < argc) agg_slide_s = std::stod(argv[i]);
+        } else if (arg == "--no-raw") {
+            publish_raw = false;
+        } else if (arg == "-F" || arg == "--fusion") {
+            fusion_enabled = true;
+        } else if (arg == "-s" || arg == "--shm") {
+            if (++i < argc) shm_name = argv[i];
+        } else if (arg == "--shm-history") {
+            if (++i < argc) shm_history = std::stoul(argv[i]);
+        } else if (arg == "-G" || arg == "--governor") {
+            governor_enabled = true;
+        } else if (arg == "--cpu-budget") {
+            if (++i < argc) governor_config.cpu_budget = std::stod(argv[i]) / 100.0;
+        } else if (arg == "--mem-budget") {
+            if (++i < argc) governor_config.memory_budget = std::stoull(argv[i]) * 1024 * 1024;
+        } else if (arg == "--rt") {
+            rt_enabled = true;
+        } else if (arg == "--rt-priority") {
+            if (++i < argc) rt_config.priority = std::stoi(argv[i]);
+        } else if (arg == "--rt-cpu") {
+            if (++i < argc) rt_config.cpu = std::stoi(argv[i]);
+        } else if (arg == "--rt-report") {
+            if (++i < argc) rt_report_s = std::stoi(argv[i]);
+        } else if (arg == "--no-lanes") {
+            lanes_enabled = false;
+        } else if (arg == "--lane-scheduling") {
+            if (++i < argc) {
+                std::string mode = argv[i];
+                if (mode == "weighted") {
+                    lane_scheduling = MqttClient::kWeighted;
+                } else if (mode != "strict") {
+                    std::cerr << "Unknown lane scheduling: " << mode << std::endl;
+                    return 1;
+                }
+            }
+        } else if (arg == "--lane-window") {
+            if (++i < argc) lane_window = std::stoul(argv[i]);
+        } else if (arg == "--heartbeat") {
+            if (++i < argc) heartbeat_s = std::stod(argv[i]);
+        } else if (arg == "--heartbeat-devices") {
+            if (++i < argc) heartbeat_devices = std::stoul(argv[i]);
+        } else if (arg == "--no-batch") {
+            batch_publish = false;
+        } else if (arg == "--tcp-nodelay") {
+            tcp_nodelay = true;
+        } else if (arg == "--history-memory") {
+            if (++i < argc) history_config.memory_bytes = std::stoul(argv[i]) * 1024;
+        } else if (arg == "--history-file") {
+            if (++i < argc) history_config.spill_path = argv[i];
+        } else if (arg == "--history-file-size") {
+            if (++i < argc) history_config.spill_bytes = std::stoull(argv[i]) * 1024 * 1024;
+        } else if (arg == "--no-history") {
+            history_enabled = false;
+        } else if (arg == "--gps-device") {
+            if (++i < argc) gps_device = argv[i];
+        } else if (arg == "--gps-baud") {
+            if (++i < argc) gps_baud = std::stoi(argv[i]);
         } else {
             std::cerr << "Unknown option: " << arg << std::endl;
             printUsage(argv[0]);
@@ -124,6 +252,31 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // A rate overrides the millisecond interval and allows sub-millisecond periods
+    std::chrono::microseconds period(static_cast<int64_t>(interval_ms) * 1000);
+    if (rate_hz > 0.0) {
+        period = std::chrono::microseconds(static_cast<int64_t>(1e6 / rate_hz));
+        interval_ms = std::max<int>(1, static_cast<int>(period.count() / 1000));
+    }
+
+    if (heartbeat_devices > 0 && heartbeat_s <= 0.0) {
+        heartbeat_s = 1.0;
+    }
+
+    if (!publish_raw && agg_window_s <= 0.0) {
+        std::cerr << "--no-raw requires --agg-window" << std::endl;
+        return 1;
+    }
+
+    // Optional streaming aggregation stage. The window is rounded up to a
+    // whole number of slides, so the banner reports the aggregator's values.
+    std::unique_ptr<SensorAggregator> aggregator;
+    if (agg_window_s > 0.0) {
+        int64_t window_ms = static_cast<int64_t>(agg_window_s * 1000.0);
+        int64_t slide_ms = agg_slide_s > 0.0 ? static_cast<int64_t>(agg_slide_s * 1000.0) : window_ms;
+        aggregator = std::make_unique<SensorAggregator>(window_ms, slide_ms, temp_min, temp_max);
+    }
+
     // Set up signal handling
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
@@ -131,11 +284,54 @@ int main(int argc, char* argv[]) {
     std::cout << "Sensor Simulator for IMX8MP" << std::endl;
     std::cout << "==========================" << std::endl;
     std::cout << "MQTT Broker: " << broker << ":" << port << std::endl;
-    std::cout << "Update Interval: " << interval_ms << "ms" << std::endl;
+    if (rate_hz > 0.0) {
+        std::cout << "Update Rate: " << rate_hz << " Hz" << std::endl;
+    } else {
+        std::cout << "Update Interval: " << interval_ms << "ms" << std::endl;
+    }
     std::cout << "CPU Temperature Range: " << temp_min << "°C - " << temp_max << "°C" << std::endl;
     std::cout << "Compass Variation: " << compass_var << "°" << std::endl;
     std::cout << "GPS Drift: " << gps_drift << " m/s" << std::endl;
     std::cout << "Client ID: " << client_id << std::endl;
+    if (!shm_name.empty()) {
+        std::cout << "Shared Memory Ring: /dev/shm/" << shm_name << " (" << shm_history << " slots)" << std::endl;
+    }
+    if (!gps_device.empty()) {
+        std::cout << "GPS Receiver: " << gps_device << " @ " << gps_baud << " baud" << std::endl;
+    }
+    std::cout << "GPS/Compass Fusion: " << (fusion_enabled ? "enabled" : "disabled") << std::endl;
+    std::cout << "Rate Governor: " << (governor_enabled ? "enabled" : "disabled") << std::endl;
+    std::cout << "Priority Lanes: "
+              << (lanes_enabled ? (lane_scheduling == MqttClient::kWeighted ? "weighted" : "strict") : "disabled")
+              << std::endl;
+    std::cout << "Tick Batching: " << (batch_publish ? "enabled" : "disabled") << std::endl;
+    std::cout << "TCP_NODELAY: " << (tcp_nodelay ? "on" : "off") << std::endl;
+    if (heartbeat_s > 0.0) {
+        std::cout << "Heartbeat: every " << heartbeat_s << "s for " << (heartbeat_devices + 1) << " device(s)" << std::endl;
+    }
+    if (rt_enabled) {
+        std::cout << "Real-time Sampling: SCHED_FIFO priority " << rt_config.priority;
+        if (rt_config.cpu >= 0) {
+            std::cout << ", CPU " << rt_config.cpu;
+        }
+        std::cout << std::endl;
+    }
+    if (history_enabled) {
+        std::cout << "Sample History: " << history_config.memory_bytes / 1024 << " KiB in memory";
+        if (!history_config.spill_path.empty()) {
+            std::cout << ", spilling to " << history_config.spill_path
+                      << " (" << history_config.spill_bytes / (1024 * 1024) << " MiB)";
+        }
+        std::cout << std::endl;
+    }
+    if (aggregator) {
+        std::cout << "Aggregation Window: " << aggregator->windowMs() / 1000.0 << "s, slide "
+                  << aggregator->slideMs() / 1000.0 << "s";
+        if (aggregator->windowMs() != static_cast<int64_t>(agg_window_s * 1000.0)) {
+            std::cout << " (rounded up from " << agg_window_s << "s to a multiple of the slide)";
+        }
+        std::cout << (publish_raw ? "" : " (raw publishing disabled)") << std::endl;
+    }
     std::cout << std::endl;
 
     // Initialize components
@@ -149,13 +345,80 @@ int main(int argc, char* argv[]) {
     simulator.setGpsDrift(gps_drift);
     simulator.setUpdateInterval(interval_ms);
 
+    // Optional shared-memory transport for co-located readers
+    ShmRingWriter shm_writer;
+    if (!shm_name.empty() && !shm_writer.open(shm_name, shm_history)) {
+        std::cerr << "Failed to open shared-memory ring. Exiting." << std::endl;
+        return 1;
+    }
+
+    // Compressed sample history served by the 'history' action
+    HistoryStore history(history_config);
+    if (history_enabled && !history.open()) {
+        std::cerr << "Failed to open sample history. Exiting." << std::endl;
+        return 1;
+    }
+
+    // Optional NMEA receiver replacing the simulated position
+    std::unique_ptr<GpsReceiver> gps_receiver;
+    if (!gps_device.empty()) {
+        gps_receiver = std::make_unique<GpsReceiver>(gps_device, gps_baud);
+        if (!gps_receiver->start()) {
+            std::cerr << "Failed to start GPS receiver. Exiting." << std::endl;
+            return 1;
+        }
+    }
+    bool gps_valid = !gps_receiver;
+
+    // Optional GPS/compass fusion stage
+    SensorFusion fusion;
+
+    SensorAggregate aggregate;
+
+    // Optional rate governor; started on the publishing thread below
+    RateGovernor governor(governor_config);
+    // Status payloads are serialized once; only their timestamps are patched
+    StatusTemplate online_status(client_id, sensor::StatusMessage::ONLINE, "Sensor simulator online");
+    StatusTemplate offline_status(client_id, sensor::StatusMessage::OFFLINE, "Sensor simulator offline");
+    auto nowMs = []() {
+        return ProtobufConverter::timestampToUnixMs(std::chrono::system_clock::now());
+    };
+    auto onlineStatus = [&governor, &online_status, &nowMs, governor_enabled, client_id]() {
+        return governor_enabled ? ProtobufConverter::createGovernorStatus(governor.snapshot(), client_id)
+                                : online_status.at(nowMs());
+    };
+
+    // Heartbeats for this device and any simulated fleet, published in one pass
+    std::vector<StatusTemplate> heartbeats;
+    std::vector<std::string> heartbeat_topics;
+    if (heartbeat_s > 0.0) {
+        heartbeats.reserve(heartbeat_devices + 1);
+        heartbeat_topics.reserve(heartbeat_devices + 1);
+        for (size_t d = 0; d <= heartbeat_devices; d++) {
+            std::string device_id = d == 0 ? client_id : client_id + "_" + std::to_string(d);
+            heartbeats.emplace_back(device_id, sensor::StatusMessage::HEARTBEAT, "");
+            heartbeat_topics.push_back("sensor/heartbeat/" + device_id);
+        }
+    }
+    auto heartbeat_period = std::chrono::microseconds(static_cast<int64_t>(heartbeat_s * 1e6));
+    auto next_heartbeat = std::chrono::steady_clock::now();
+
     // Configure MQTT client
     mqtt_client.setClientId(client_id);
     if (!username.empty()) {
         mqtt_client.setUsername(username);
         mqtt_client.setPassword(password);
     }
-    mqtt_client.setWill("sensor/status", ProtobufConverter::createOfflineStatus(client_id), 1);
+    mqtt_client.setWill("sensor/status", offline_status.at(nowMs()), 1);
+    mqtt_client.setLanesEnabled(lanes_enabled);
+    mqtt_client.setLaneScheduling(lane_scheduling);
+    mqtt_client.setLaneWindow(lane_window);
+    mqtt_client.setBatchingEnabled(batch_publish);
+    mqtt_client.setTcpNoDelay(tcp_nodelay);
+    if (!heartbeats.empty()) {
+        // Room for two passes; an undrained pass loses its oldest heartbeats first
+        mqtt_client.setLaneConfig(MqttClient::kHeartbeat, {0, false, std::max<size_t>(1024, 2 * heartbeats.size()), 1});
+    }
 
     // Instantiate ActionHandler
     ActionHandler action_handler;
@@ -163,6 +426,72 @@ int main(int argc, char* argv[]) {
     // Register action handlers
     action_handler.register_action_handler("reboot", handle_action_reboot);
     action_handler.register_action_handler("message", handle_action_message);
+    action_handler.register_action_handler("ping", handle_action_ping);
+
+    // 'history' action: streams the compressed blocks overlapping the requested
+    // range as HistoryChunk messages, then acks with a summary
+    if (history_enabled) {
+        action_handler.register_streaming_handler("history",
+            [&history, client_id](const std::string& payload, const ActionHandler::EmitFunc& emit) -> std::string {
+            const size_t kChunkBytes = 32 * 1024;
+            int64_t now_ms = ProtobufConverter::timestampToUnixMs(std::chrono::system_clock::now());
+            HistoryQuery query;
+            std::string error;
+            if (!HistoryQuery::parse(payload, now_ms, query, error)) {
+                return "history: " + error;
+            }
+
+            // Counts cover only chunks that were handed on; the first chunk that
+            // fails to serialize or send ends the stream
+            sensor::HistoryChunk chunk;
+            uint32_t chunks = 0;
+            size_t blocks = 0;
+            size_t pending_blocks = 0;
+            size_t sent_bytes = 0;
+            bool truncated = false;
+            bool failed = false;
+            auto flush = [&]() {
+                if (chunk.blocks_size() == 0) {
+                    return true;
+                }
+                chunk.set_device_id(client_id);
+                chunk.set_chunk_index(chunks);
+                std::string serialized;
+                bool ok = chunk.SerializeToString(&serialized) && emit(serialized);
+                chunk.Clear();
+                if (!ok) {
+                    failed = true;
+                    return false;
+                }
+                chunks++;
+                blocks += pending_blocks;
+                pending_blocks = 0;
+                sent_bytes += serialized.size();
+                return true;
+            };
+
+            history.query(query.from_ms, query.to_ms, [&](const EncodedBlock& block) {
+                ProtobufConverter::appendHistoryBlock(chunk, block, query.column_mask);
+                if (sent_bytes + chunk.ByteSizeLong() > query.max_bytes) {
+                    chunk.mutable_blocks()->RemoveLast();
+                    truncated = true;
+                    return false;
+                }
+                pending_blocks++;
+                return chunk.ByteSizeLong() < kChunkBytes || flush();
+            });
+            if (!failed) {
+                flush();
+            }
+
+            std::string summary = std::to_string(blocks) + " blocks in " + std::to_string(chunks) +
+                                  " chunks, " + std::to_string(sent_bytes) + " bytes";
+            if (failed) {
+                return "history: failed to send chunk " + std::to_string(chunks) + " after " + summary;
+            }
+            return "history: " + summary + (truncated ? " (truncated by max_bytes)" : "");
+        });
+    }
 
     // Set up MQTT message handler
     mqtt_client.setOnMessage([&mqtt_client, &action_handler](const std::string& topic, const std::string& payload) {
@@ -171,7 +500,38 @@ int main(int argc, char* argv[]) {
             std::string full_topic = req.topic();
             std::string action_topic = full_topic.substr(full_topic.find_last_of('/') + 1);
             std::string ack_topic = req.ack_topic();
-            auto [found, result] = action_handler.run_handler(action_topic, req.payload());
+
+            // Streamed chunks go out on the bulk lane, and the final ack follows
+            // them there: the lane is FIFO, so the ack cannot overtake a chunk.
+            // A chunk counts as sent only if the lane took it without evicting
+            // an earlier one, and the last slot is left for the ack.
+            uint32_t chunk_index = 0;
+            auto emit = [&](const std::string& chunk) {
+                if (ack_topic.empty()) {
+                    return false;
+                }
+                actions::ActionAck chunk_msg;
+                chunk_msg.set_ack(action_topic);
+                chunk_msg.set_success(true);
+                chunk_msg.set_chunk(chunk);
+                chunk_msg.set_chunk_index(chunk_index);
+                chunk_msg.set_more(true);
+                std::string chunk_payload;
+                if (!chunk_msg.SerializeToString(&chunk_payload)) {
+                    return false;
+                }
+                MqttClient::LaneStats bulk = mqtt_client.laneStats(MqttClient::kBulk);
+                if (bulk.queued + 2 > mqtt_client.laneConfig(MqttClient::kBulk).queue_limit) {
+                    return false;
+                }
+                if (!mqtt_client.publish(MqttClient::kBulk, ack_topic, chunk_payload) ||
+                    mqtt_client.laneStats(MqttClient::kBulk).dropped != bulk.dropped) {
+                    return false;
+                }
+                chunk_index++;
+                return true;
+            };
+            auto [found, result] = action_handler.run_handler(action_topic, req.payload(), emit);
             if (found) {
                 std::cout << "[MQTT] ActionRequest handled for topic '" << action_topic << "', result: '" << result << "'\n";
             } else {
@@ -184,10 +544,11 @@ int main(int argc, char* argv[]) {
                 ack_msg.set_success(found);
                 ack_msg.set_error(found ? "" : "No handler found");
                 ack_msg.set_allocated_ack(new std::string(result));
+                ack_msg.set_chunk_index(chunk_index);
                 std::string ack_payload;
                 ack_msg.SerializeToString(&ack_payload);
                 //mqtt_client.publish(ack_full_topic, ack_payload, 1);
-                mqtt_client.publish(ack_topic, ack_payload, 1);
+                mqtt_client.publish(chunk_index > 0 ? MqttClient::kBulk : MqttClient::kControl, ack_topic, ack_payload);
                 std::cout << "[MQTT] Published ack to '" << ack_topic << "'\n";
             }
         } else {
@@ -196,12 +557,12 @@ int main(int argc, char* argv[]) {
     });
 
     // Set up MQTT callbacks
-    mqtt_client.setOnConnect([client_id](int rc) {
+    mqtt_client.setOnConnect([&onlineStatus](int rc) {
         if (rc == 0) {
             std::cout << "Connected to MQTT broker successfully" << std::endl;
             // Publish online status
             if (g_mqtt_client) {
-                g_mqtt_client->publishRetained("sensor/status", ProtobufConverter::createOnlineStatus(client_id), 1);
+                g_mqtt_client->publish(MqttClient::kStatus, "sensor/status", onlineStatus());
                 // Subscribe to all actions topics
                 g_mqtt_client->subscribe("action/#", 1);
             }
@@ -242,43 +603,193 @@ int main(int argc, char* argv[]) {
     std::cout << "Press Ctrl+C to stop" << std::endl;
     std::cout << std::endl;
 
-    // Main simulation loop
-    while (running) {
-        try {
-            // Generate sensor data
-            SensorData data = simulator.generateSensorData();
-
-            // Convert to protobuf and publish
-            std::string all_data_pb = ProtobufConverter::sensorDataToProtobuf(data, client_id);
-            std::string temp_pb = ProtobufConverter::temperatureToProtobuf(data, client_id);
-            std::string compass_pb = ProtobufConverter::compassToProtobuf(data, client_id);
-            std::string gps_pb = ProtobufConverter::gpsToProtobuf(data, client_id);
-
-            // Publish to MQTT topics
-            mqtt_client.publish("sensor/all", all_data_pb);
-            mqtt_client.publish("sensor/temperature", temp_pb);
-            mqtt_client.publish("sensor/compass", compass_pb);
-            mqtt_client.publish("sensor/gps", gps_pb);
-
-            // Print status
-            /*std::cout << "Published sensor data - "
-                      << "CPU: " << data.cpu_temperature << "°C, "
-                      << "Compass: " << data.compass_heading << "°, "
-                      << "GPS: " << data.gps_latitude << "," << data.gps_longitude
-                      << " (" << data.gps_altitude << "m)" << std::endl;
-            */
-            // Wait for next update
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
-
-        } catch (const std::exception& e) {
-            std::cerr << "Error in simulation loop: " << e.what() << std::endl;
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+    if (governor_enabled) {
+        governor.start();
+        GovernorReport report = governor.snapshot();
+        std::cout << "Governor budget: CPU ";
+        if (report.cpu_budget > 0.0) {
+            std::cout << report.cpu_budget * 100.0 << "%";
+        } else {
+            std::cout << "unlimited";
+        }
+        std::cout << ", memory ";
+        if (report.memory_budget > 0) {
+            std::cout << report.memory_budget / (1024 * 1024) << " MiB";
+        } else {
+            std::cout << "unlimited";
+        }
+        std::cout << std::endl;
+    }
+
+    // Without --governor every channel publishes and the governor keeps no state
+    auto admit = [&governor, governor_enabled](RateGovernor::Channel channel, const SensorData& data) {
+        return !governor_enabled || governor.admit(channel, data);
+    };
+
+    // Everything downstream of sampling: fusion, local transports and publishing
+    auto processSample = [&](SensorData& data) {
+        // A real receiver replaces the simulated position once it has reported
+        // one. After a fix is lost the last position is kept; before the first
+        // one the simulated values stay. Either way sensor/gps and fusion are held.
+        if (gps_receiver) {
+            GpsFix fix;
+            bool known = gps_receiver->latest(fix);
+            if (known && fix.valid != gps_valid) {
+                std::cout << "[GPS] " << (fix.valid ? "Fix acquired" : "Fix lost") << std::endl;
+            }
+            gps_valid = known && fix.valid;
+            if (known) {
+                data.gps_latitude = fix.latitude;
+                data.gps_longitude = fix.longitude;
+                data.gps_altitude = fix.altitude;
+                data.gps_accuracy = fix.accuracy;
+            }
+        }
+
+        if (fusion_enabled && gps_valid) {
+            fusion.apply(data);
+        }
+
+        // Local readers get the sample before any serialization
+        shm_writer.publish(data);
+        if (history_enabled) {
+            history.append(data);
+        }
+
+        // The tick's messages leave together on flush() unless --no-batch
+        mqtt_client.begin();
+
+        // Fold into the aggregation window; publish when a window closes
+        if (aggregator && aggregator->addSample(data, aggregate)) {
+            mqtt_client.publish(MqttClient::kTelemetry, "sensor/agg", ProtobufConverter::aggregateToProtobuf(aggregate, client_id));
+        }
+
+        if (publish_raw) {
+            // Convert to protobuf and publish whatever the governor admits
+            if (admit(RateGovernor::kAll, data)) {
+                mqtt_client.publish(MqttClient::kTelemetry, "sensor/all", ProtobufConverter::sensorDataToProtobuf(data, client_id));
+            }
+            if (admit(RateGovernor::kTemperature, data)) {
+                mqtt_client.publish(MqttClient::kTelemetry, "sensor/temperature", ProtobufConverter::temperatureToProtobuf(data, client_id));
+            }
+            if (admit(RateGovernor::kCompass, data)) {
+                mqtt_client.publish(MqttClient::kTelemetry, "sensor/compass", ProtobufConverter::compassToProtobuf(data, client_id));
+            }
+            if (gps_valid && admit(RateGovernor::kGps, data)) {
+                mqtt_client.publish(MqttClient::kTelemetry, "sensor/gps", ProtobufConverter::gpsToProtobuf(data, client_id));
+            }
+        }
+
+        // Re-evaluate the budget; level changes replace the retained status
+        if (governor_enabled && governor.update(std::chrono::steady_clock::now())) {
+            GovernorReport report = governor.snapshot();
+            std::cout << "[Governor] " << GovernorReport::levelName(report.level)
+                      << ": " << report.reason << std::endl;
+            mqtt_client.publish(MqttClient::kStatus, "sensor/status", onlineStatus());
+        }
+
+        // Heartbeats have a lane of their own below telemetry, sized for a
+        // whole pass, so a fleet pass neither stalls telemetry nor evicts history chunks
+        if (!heartbeats.empty() && mqtt_client.isConnected()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= next_heartbeat) {
+                next_heartbeat += heartbeat_period;
+                if (next_heartbeat < now) {
+                    next_heartbeat = now + heartbeat_period;
+                }
+                int64_t now_ms = nowMs();
+                for (size_t d = 0; d < heartbeats.size(); d++) {
+                    mqtt_client.publish(MqttClient::kHeartbeat, heartbeat_topics[d], heartbeats[d].at(now_ms));
+                }
+            }
+        }
+
+        mqtt_client.flush();
+    };
+
+    if (rt_enabled) {
+        // Sampling runs on the real-time thread; this thread only drains and publishes
+        RtSampler sampler(simulator, std::chrono::duration_cast<std::chrono::nanoseconds>(period), rt_config);
+        if (!sampler.start()) {
+            for (const auto& warning : sampler.warnings()) {
+                std::cerr << "[RT] " << warning << std::endl;
+            }
+            std::cerr << "Failed to start the sampling thread. Exiting." << std::endl;
+            return 1;
+        }
+        std::cout << "[RT] Sampling thread " << (sampler.realtime() ? "running SCHED_FIFO" : "running SCHED_OTHER")
+                  << " priority " << rt_config.priority << std::endl;
+        for (const auto& warning : sampler.warnings()) {
+            std::cout << "[RT] Fallback: " << warning << std::endl;
+        }
+
+        auto printJitter = [&sampler]() {
+            JitterStats stats = sampler.takeStats();
+            std::cout << "[RT] ticks=" << stats.ticks
+                      << " period_err_us p50=" << stats.period_p50_us
+                      << " p99=" << stats.period_p99_us
+                      << " p99.9=" << stats.period_p999_us
+                      << " max=" << stats.period_max_us
+                      << " wake_max_us=" << stats.wake_max_us
+                      << " overruns=" << stats.overruns
+                      << " dropped=" << stats.dropped << std::endl;
+        };
+
+        auto next_report = std::chrono::steady_clock::now() + std::chrono::seconds(rt_report_s);
+        SensorData data;
+        while (running) {
+            try {
+                sampler.waitForData(100);
+                while (sampler.pop(data)) {
+                    processSample(data);
+                }
+                if (rt_report_s > 0 && std::chrono::steady_clock::now() >= next_report) {
+                    printJitter();
+                    next_report += std::chrono::seconds(rt_report_s);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error in simulation loop: " << e.what() << std::endl;
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+        }
+        sampler.stop();
+        printJitter();
+    } else {
+        // Main simulation loop; ticks are scheduled on absolute deadlines so the
+        // publish time does not accumulate into the period
+        auto next_tick = std::chrono::steady_clock::now();
+        while (running) {
+            try {
+                // Generate sensor data
+                SensorData data = simulator.generateSensorData();
+                processSample(data);
+
+                // Wait for next update
+                next_tick += period;
+                auto now = std::chrono::steady_clock::now();
+                if (next_tick < now) {
+                    next_tick = now;  // overran; do not try to catch up in a burst
+                }
+                std::this_thread::sleep_until(next_tick);
+
+            } catch (const std::exception& e) {
+                std::cerr << "Error in simulation loop: " << e.what() << std::endl;
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
         }
     }
 
     // Cleanup
     std::cout << "Shutting down..." << std::endl;
-    mqtt_client.publishRetained("sensor/status", ProtobufConverter::createOfflineStatus(client_id), 1);
+    if (gps_receiver) {
+        gps_receiver->stop();
+        NmeaStats stats = gps_receiver->stats();
+        std::cout << "[GPS] sentences=" << stats.sentences
+                  << " checksum_errors=" << stats.checksum_errors
+                  << " overflows=" << stats.overflows
+                  << " ignored=" << stats.ignored << std::endl;
+    }
+    mqtt_client.publishRetained("sensor/status", offline_status.at(nowMs()), 1);
     mqtt_client.disconnect();
     mqtt_client.loopStop();
 
@@ -1,12 +1,36 @@
 #include "mqtt_client.h"
+#include <algorithm>
 #include <iostream>
 #include <cstring>
+#include <thread>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
 
 MqttClient::MqttClient() 
     : mosq_(nullptr)
     , will_qos_(0)
     , connected_(false)
+    , scheduling_(kStrict)
+    , window_(16)
+    , outstanding_(0)
+    , lanes_enabled_(true)
+    , batch_size_(0)
+    , batch_open_(false)
+    , batching_enabled_(true)
+    , corked_(false)
+    , tcp_nodelay_(false)
+    , loop_running_(false)
+    , disconnecting_(false)
 {
+    // Defaults: acks and status are reliable and small, telemetry is
+    // fire-and-forget and may shed its oldest samples under load
+    lanes_[kControl].config = {1, false, 256, 8};
+    lanes_[kStatus].config = {1, true, 16, 4};
+    lanes_[kTelemetry].config = {0, false, 4096, 2};
+    lanes_[kHeartbeat].config = {0, false, 1024, 1};
+    lanes_[kBulk].config = {1, false, 1024, 1};
+
     // Initialize mosquitto library
     mosquitto_lib_init();
     
@@ -24,6 +48,7 @@ MqttClient::MqttClient()
 }
 
 MqttClient::~MqttClient() {
+    loopStop();
     if (mosq_) {
         mosquitto_destroy(mosq_);
     }
@@ -53,6 +78,7 @@ bool MqttClient::connect(const std::string& broker, int port, int keepalive) {
     }
     
     // Connect to broker
+    disconnecting_ = false;
     int rc = mosquitto_connect(mosq_, broker.c_str(), port, keepalive);
     if (rc != MOSQ_ERR_SUCCESS) {
         std::cerr << "Failed to connect to MQTT broker: " << mosquitto_strerror(rc) << std::endl;
@@ -63,6 +89,7 @@ bool MqttClient::connect(const std::string& broker, int port, int keepalive) {
 }
 
 void MqttClient::disconnect() {
+    disconnecting_ = true;
     if (mosq_ && connected_) {
         mosquitto_disconnect(mosq_);
         connected_ = false;
@@ -79,12 +106,14 @@ bool MqttClient::publish(const std::string& topic, const std::string& message, i
         return false;
     }
     
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
     int rc = mosquitto_publish(mosq_, nullptr, topic.c_str(), message.length(), 
                               message.c_str(), qos, false);
     if (rc != MOSQ_ERR_SUCCESS) {
         std::cerr << "Failed to publish message: " << mosquitto_strerror(rc) << std::endl;
         return false;
     }
+    outstanding_++;
     
     return true;
 }
@@ -95,16 +124,262 @@ bool MqttClient::publishRetained(const std::string& topic, const std::string& me
         return false;
     }
     
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
     int rc = mosquitto_publish(mosq_, nullptr, topic.c_str(), message.length(), 
                               message.c_str(), qos, true);
     if (rc != MOSQ_ERR_SUCCESS) {
         std::cerr << "Failed to publish retained message: " << mosquitto_strerror(rc) << std::endl;
         return false;
     }
+    outstanding_++;
     
     return true;
 }
 
+bool MqttClient::publish(Lane lane, const std::string& topic, const std::string& message) {
+    if (!mosq_) {
+        std::cerr << "Mosquitto instance not initialized" << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+
+    // Held for flush() while the calling thread has a transaction open
+    if (batch_open_ && batch_owner_ == std::this_thread::get_id()) {
+        if (batch_size_ == batch_.size()) {
+            batch_.emplace_back();
+        }
+        BatchedMessage& entry = batch_[batch_size_++];
+        entry.lane = lane;
+        size_t size = topic.size() + 1 + message.size();
+        if (entry.message.packet.capacity() < size && !spare_packets_.empty()) {
+            entry.message.packet.swap(spare_packets_.back());
+            spare_packets_.pop_back();
+        }
+        entry.message.assign(topic, message);
+        return true;
+    }
+
+    // Messages that go straight out are not copied first
+    if (dispatchesDirectlyLocked(lane)) {
+        lanes_[lane].stats.enqueued++;
+        return dispatchLocked(lane, topic.c_str(), message.data(), message.size());
+    }
+
+    PackedMessage packed;
+    packed.assign(topic, message);
+    bool queued = enqueueLocked(lane, std::move(packed), std::chrono::steady_clock::now());
+    if (connected_) {
+        pumpLocked();
+    }
+    return queued;
+}
+
+void MqttClient::PackedMessage::assign(const std::string& topic, const std::string& payload) {
+    packet.reserve(topic.size() + 1 + payload.size());
+    packet.assign(topic);
+    packet.push_back('\0');
+    packet.append(payload);
+    topic_size = topic.size();
+}
+
+// Control messages, and everything when lanes are disabled, go straight out
+bool MqttClient::dispatchesDirectlyLocked(Lane lane) const {
+    return connected_ && (lane == kControl || !lanes_enabled_);
+}
+
+bool MqttClient::enqueueLocked(Lane lane, PackedMessage&& message, std::chrono::steady_clock::time_point now) {
+    LaneState& state = lanes_[lane];
+    state.stats.enqueued++;
+
+    if (dispatchesDirectlyLocked(lane)) {
+        return dispatchLocked(lane, message.topic(), message.payload(), message.payloadSize());
+    }
+
+    if (state.queue.size() >= state.config.queue_limit) {
+        if (state.config.queue_limit == 0) {
+            state.stats.dropped++;
+            return false;
+        }
+        recycleLocked(state.queue.front().message.packet);
+        state.queue.pop_front();
+        state.stats.dropped++;
+    }
+    state.queue.push_back({std::move(message), now});
+    return true;
+}
+
+void MqttClient::begin() {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    if (!batching_enabled_) {
+        return;
+    }
+    batch_open_ = true;
+    batch_owner_ = std::this_thread::get_id();
+    batch_size_ = 0;
+}
+
+bool MqttClient::flush() {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    if (!batch_open_ || batch_owner_ != std::this_thread::get_id()) {
+        return true;
+    }
+    batch_open_ = false;
+
+    // Corked from the tick's first packet until the loop thread has written
+    // them all, so acks from other threads are only held for that span
+    bool cork = batch_size_ > 0 && connected_;
+    if (cork) {
+        setCork(true);
+    }
+
+    bool ok = true;
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < batch_size_; i++) {
+        BatchedMessage& entry = batch_[i];
+        ok = enqueueLocked(entry.lane, std::move(entry.message), now) && ok;
+    }
+    if (cork) {
+        pumpLocked();
+    }
+    batch_size_ = 0;
+
+    // With nothing left to write the cork goes now
+    if (cork) {
+        if (mosquitto_want_write(mosq_)) {
+            corked_ = true;
+        } else {
+            setCork(false);
+        }
+    }
+    return ok;
+}
+
+void MqttClient::setBatchingEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    batching_enabled_ = enabled;
+}
+
+void MqttClient::setTcpNoDelay(bool enabled) {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    tcp_nodelay_ = enabled;
+}
+
+void MqttClient::setCork(bool corked) {
+#ifdef TCP_CORK
+    int fd = mosquitto_socket(mosq_);
+    if (fd >= 0) {
+        int value = corked ? 1 : 0;
+        setsockopt(fd, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+    }
+#else
+    (void)corked;
+#endif
+}
+
+void MqttClient::setLaneConfig(Lane lane, const LaneConfig& config) {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    lanes_[lane].config = config;
+}
+
+void MqttClient::setLaneScheduling(LaneScheduling scheduling) {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    scheduling_ = scheduling;
+}
+
+void MqttClient::setLaneWindow(size_t packets) {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    window_ = packets > 0 ? packets : 1;
+}
+
+void MqttClient::setLanesEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    lanes_enabled_ = enabled;
+}
+
+MqttClient::LaneConfig MqttClient::laneConfig(Lane lane) const {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    return lanes_[lane].config;
+}
+
+MqttClient::LaneStats MqttClient::laneStats(Lane lane) const {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    LaneStats stats = lanes_[lane].stats;
+    stats.queued = lanes_[lane].queue.size();
+    return stats;
+}
+
+int MqttClient::pickLaneLocked() {
+    if (scheduling_ == kStrict) {
+        for (int lane = 0; lane < kLaneCount; lane++) {
+            if (!lanes_[lane].queue.empty()) {
+                return lane;
+            }
+        }
+        return -1;
+    }
+
+    // Smooth weighted round-robin over the non-empty lanes
+    int best = -1;
+    int64_t total = 0;
+    for (int lane = 0; lane < kLaneCount; lane++) {
+        LaneState& state = lanes_[lane];
+        if (state.queue.empty()) {
+            continue;
+        }
+        state.current_weight += state.config.weight;
+        total += state.config.weight;
+        if (best < 0 || state.current_weight > lanes_[best].current_weight) {
+            best = lane;
+        }
+    }
+    if (best >= 0) {
+        lanes_[best].current_weight -= total;
+    }
+    return best;
+}
+
+bool MqttClient::dispatchLocked(Lane lane, const char* topic, const void* payload, size_t length) {
+    LaneState& state = lanes_[lane];
+    int rc = mosquitto_publish(mosq_, nullptr, topic, static_cast<int>(length),
+                               payload, state.config.qos, state.config.retain);
+    if (rc != MOSQ_ERR_SUCCESS) {
+        std::cerr << "Failed to publish message: " << mosquitto_strerror(rc) << std::endl;
+        state.stats.dropped++;
+        return false;
+    }
+    state.stats.sent++;
+    outstanding_++;
+    return true;
+}
+
+void MqttClient::recycleLocked(std::string& packet) {
+    // Tick-sized packets only; a history chunk would pin its 32 KiB
+    const size_t kMaxSparePacket = 1024;
+    if (spare_packets_.size() < batch_.size() && packet.capacity() <= kMaxSparePacket) {
+        spare_packets_.push_back(std::move(packet));
+    }
+}
+
+void MqttClient::pumpLocked() {
+    auto now = std::chrono::steady_clock::now();
+    while (outstanding_ < window_) {
+        int lane = pickLaneLocked();
+        if (lane < 0) {
+            break;
+        }
+        LaneState& state = lanes_[lane];
+        QueuedMessage& front = state.queue.front();
+        double wait_ms = std::chrono::duration<double, std::milli>(now - front.enqueued).count();
+        state.stats.total_wait_ms += wait_ms;
+        state.stats.max_wait_ms = std::max(state.stats.max_wait_ms, wait_ms);
+        dispatchLocked(static_cast<Lane>(lane), front.message.topic(), front.message.payload(),
+                       front.message.payloadSize());
+        recycleLocked(front.message.packet);
+        state.queue.pop_front();
+    }
+}
+
 bool MqttClient::subscribe(const std::string& topic, int qos) {
     if (!mosq_ || !connected_) {
         std::cerr << "Not connected to MQTT broker" << std::endl;
@@ -128,6 +403,9 @@ void MqttClient::setClientId(const std::string& client_id) {
             mosquitto_connect_callback_set(mosq_, onConnect);
             mosquitto_disconnect_callback_set(mosq_, onDisconnect);
             mosquitto_publish_callback_set(mosq_, onPublish);
+            if (on_message_callback_ || on_raw_message_callback_) {
+                mosquitto_message_callback_set(mosq_, onMessage);
+            }
         }
     }
 }
@@ -165,20 +443,68 @@ void MqttClient::setOnMessage(std::function<void(const std::string&, const std::
     }
 }
 
+void MqttClient::setOnRawMessage(std::function<void(const char*, const void*, size_t)> callback) {
+    on_raw_message_callback_ = callback;
+    if (mosq_) {
+        mosquitto_message_callback_set(mosq_, onMessage);
+    }
+}
+
 int MqttClient::loop(int timeout_ms) {
     if (!mosq_) return MOSQ_ERR_INVAL;
     return mosquitto_loop(mosq_, timeout_ms, 1);
 }
 
 void MqttClient::loopStart() {
-    if (mosq_) {
-        mosquitto_loop_start(mosq_);
+    if (!mosq_ || loop_running_) {
+        return;
     }
+    // Publishes from other threads then only queue and wake the loop
+    mosquitto_threaded_set(mosq_, true);
+    loop_running_ = true;
+    loop_thread_ = std::thread(&MqttClient::runLoop, this);
 }
 
 void MqttClient::loopStop() {
-    if (mosq_) {
-        mosquitto_loop_stop(mosq_, true);
+    if (!loop_running_) {
+        return;
+    }
+    loop_running_ = false;
+    if (loop_thread_.joinable()) {
+        loop_thread_.join();
+    }
+}
+
+// mosquitto_loop_forever() with one addition: after every pass the tick cork
+// is released if nothing is left to write. libmosquitto has no callback for
+// an empty output queue, so this needs a loop of our own.
+void MqttClient::runLoop() {
+    const int kLoopTimeoutMs = 1000;
+    const auto kReconnectDelay = std::chrono::seconds(1);
+
+    while (loop_running_) {
+        int rc = mosquitto_loop(mosq_, kLoopTimeoutMs, 1);
+        {
+            std::lock_guard<std::mutex> lock(lanes_mutex_);
+            if (corked_ && (rc != MOSQ_ERR_SUCCESS || !mosquitto_want_write(mosq_))) {
+                setCork(false);
+                corked_ = false;
+            }
+        }
+        if (rc == MOSQ_ERR_SUCCESS) {
+            continue;
+        }
+        if (disconnecting_) {
+            break;
+        }
+
+        auto retry_at = std::chrono::steady_clock::now() + kReconnectDelay;
+        while (loop_running_ && std::chrono::steady_clock::now() < retry_at) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (loop_running_ && !disconnecting_) {
+            mosquitto_reconnect(mosq_);
+        }
     }
 }
 
@@ -186,7 +512,16 @@ void MqttClient::loopStop() {
 void MqttClient::onConnect(struct mosquitto* mosq, void* userdata, int rc) {
     MqttClient* client = static_cast<MqttClient*>(userdata);
     if (rc == 0) {
+        std::lock_guard<std::mutex> lock(client->lanes_mutex_);
         client->connected_ = true;
+        client->outstanding_ = 0;
+
+        // Only on request: it changes the timing of every message sent outside a tick
+        int fd = mosquitto_socket(mosq);
+        if (client->tcp_nodelay_ && fd >= 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
         std::cout << "Connected to MQTT broker successfully" << std::endl;
     } else {
         std::cerr << "Failed to connect to MQTT broker, return code: " << rc << std::endl;
@@ -195,11 +530,21 @@ void MqttClient::onConnect(struct mosquitto* mosq, void* userdata, int rc) {
     if (client->on_connect_callback_) {
         client->on_connect_callback_(rc);
     }
+
+    // Flush whatever the lanes held while disconnected
+    if (rc == 0) {
+        std::lock_guard<std::mutex> lock(client->lanes_mutex_);
+        client->pumpLocked();
+    }
 }
 
 void MqttClient::onDisconnect(struct mosquitto* mosq, void* userdata, int rc) {
     MqttClient* client = static_cast<MqttClient*>(userdata);
-    client->connected_ = false;
+    {
+        std::lock_guard<std::mutex> lock(client->lanes_mutex_);
+        client->connected_ = false;
+        client->outstanding_ = 0;
+    }
     std::cout << "Disconnected from MQTT broker" << std::endl;
     
     if (client->on_disconnect_callback_) {
@@ -209,6 +554,17 @@ void MqttClient::onDisconnect(struct mosquitto* mosq, void* userdata, int rc) {
 
 void MqttClient::onPublish(struct mosquitto* mosq, void* userdata, int mid) {
     MqttClient* client = static_cast<MqttClient*>(userdata);
+
+    // A packet left the window (written for QoS 0, acknowledged otherwise)
+    {
+        std::lock_guard<std::mutex> lock(client->lanes_mutex_);
+        if (client->outstanding_ > 0) {
+            client->outstanding_--;
+        }
+        if (client->connected_) {
+            client->pumpLocked();
+        }
+    }
     
     if (client->on_publish_callback_) {
         client->on_publish_callback_(mid);
@@ -217,6 +573,11 @@ void MqttClient::onPublish(struct mosquitto* mosq, void* userdata, int mid) {
 
 void MqttClient::onMessage(struct mosquitto* mosq, void* userdata, const struct mosquitto_message* message) {
     MqttClient* client = static_cast<MqttClient*>(userdata);
+    if (client && client->on_raw_message_callback_ && message) {
+        client->on_raw_message_callback_(message->topic, message->payload,
+                                         message->payloadlen > 0 ? static_cast<size_t>(message->payloadlen) : 0);
+        return;
+    }
     if (client && client->on_message_callback_ && message) {
         std::string topic = message->topic ? message->topic : "";
         std::string payload;
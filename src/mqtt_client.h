@@ -1,12 +1,55 @@
 #pragma once
 
 #include <mosquitto.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <string>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 class MqttClient {
 public:
+    // Priority lanes for the publish path. Lane messages are held in
+    // per-lane queues and handed to libmosquitto only while fewer than
+    // window packets are outstanding (not yet written, or not yet acked for
+    // QoS > 0). That way a control or status message never waits behind more
+    // than a window of telemetry. Control messages bypass the window.
+    enum Lane {
+        kControl = 0,   // action acks
+        kStatus,        // retained device status
+        kTelemetry,     // sensor/* samples and aggregates
+        kHeartbeat,     // periodic per-device liveness, possibly a whole fleet per pass
+        kBulk,          // large or backfill transfers
+        kLaneCount
+    };
+
+    enum LaneScheduling {
+        kStrict,        // always serve the highest-priority non-empty lane
+        kWeighted       // smooth weighted round-robin by LaneConfig::weight
+    };
+
+    struct LaneConfig {
+        int qos;
+        bool retain;
+        size_t queue_limit;   // oldest message dropped when exceeded
+        uint32_t weight;      // share under kWeighted
+    };
+
+    struct LaneStats {
+        uint64_t enqueued = 0;
+        uint64_t sent = 0;
+        uint64_t dropped = 0;      // overflowed the queue limit or rejected by libmosquitto
+        size_t queued = 0;
+        double max_wait_ms = 0.0;  // longest time a message spent queued
+        double total_wait_ms = 0.0;
+    };
+
     MqttClient();
     ~MqttClient();
 
@@ -18,6 +61,33 @@ public:
     // Publishing
     bool publish(const std::string& topic, const std::string& message, int qos = 0);
     bool publishRetained(const std::string& topic, const std::string& message, int qos = 0);
+    // Queues on a priority lane with the lane's QoS/retain defaults. False if
+    // the message was dropped immediately (lanes still queue while disconnected).
+    bool publish(Lane lane, const std::string& topic, const std::string& message);
+
+    // Lane configuration; set before connecting
+    void setLaneConfig(Lane lane, const LaneConfig& config);
+    void setLaneScheduling(LaneScheduling scheduling);
+    void setLaneWindow(size_t packets);
+    // Disabled lanes pass straight through to libmosquitto (for comparison)
+    void setLanesEnabled(bool enabled);
+    LaneConfig laneConfig(Lane lane) const;
+    LaneStats laneStats(Lane lane) const;
+
+    // Publish transactions. Between begin() and flush(), lane publishes from
+    // the calling thread are held back; flush() hands them to libmosquitto in
+    // one critical section. The socket is corked from then until the loop
+    // thread has written everything queued, so a tick leaves in as few TCP
+    // segments as possible instead of one per message. libmosquitto still
+    // issues one write() per packet. Publishes from other threads (action
+    // acks) are not held, and are only corked if they are written in that
+    // short span.
+    void begin();
+    bool flush();
+    // Disabled batching makes begin()/flush() no-ops (for comparison)
+    void setBatchingEnabled(bool enabled);
+    // Turns off Nagle on the broker connection (default: left on); set before connecting
+    void setTcpNoDelay(bool enabled);
 
     // Subscribing
     bool subscribe(const std::string& topic, int qos = 0);
@@ -34,8 +104,15 @@ public:
     void setOnPublish(std::function<void(int)> callback);
     // Message callback
     void setOnMessage(std::function<void(const std::string&, const std::string&)> callback);
+    // Zero-copy message callback; topic and payload point into libmosquitto's
+    // buffer and are only valid for the duration of the call. Takes precedence
+    // over the string callback when both are set.
+    void setOnRawMessage(std::function<void(const char*, const void*, size_t)> callback);
 
-    // Loop management
+    // Loop management. loopStart() runs the network loop on a thread of its
+    // own, reconnecting after a lost connection, and releases the tick cork
+    // once libmosquitto's output queue is empty. loopStop() returns promptly
+    // after disconnect(), otherwise within a second.
     int loop(int timeout_ms = -1);
     void loopStart();
     void loopStop();
@@ -50,12 +127,74 @@ private:
     int will_qos_;
     bool connected_;
 
+    // Topic, a NUL and the payload in one buffer, so a held message costs
+    // one allocation and moves from the batch into a lane without a copy
+    struct PackedMessage {
+        std::string packet;
+        size_t topic_size = 0;
+
+        void assign(const std::string& topic, const std::string& payload);
+        const char* topic() const { return packet.c_str(); }
+        const char* payload() const { return packet.data() + topic_size + 1; }
+        size_t payloadSize() const { return packet.size() - topic_size - 1; }
+    };
+
+    // Priority lanes
+    struct QueuedMessage {
+        PackedMessage message;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+    struct LaneState {
+        LaneConfig config;
+        std::deque<QueuedMessage> queue;
+        LaneStats stats;
+        int64_t current_weight = 0;
+    };
+    mutable std::mutex lanes_mutex_;
+    std::array<LaneState, kLaneCount> lanes_;
+    LaneScheduling scheduling_;
+    size_t window_;
+    size_t outstanding_;
+    bool lanes_enabled_;
+
+    // Open publish transaction; entries [0, batch_size_) are live. flush()
+    // moves their packets into the lanes.
+    struct BatchedMessage {
+        Lane lane;
+        PackedMessage message;
+    };
+    std::vector<BatchedMessage> batch_;
+    size_t batch_size_;
+    // Small packets of sent or evicted messages, reused by the next
+    // transaction's entries so steady ticks stop allocating; at most batch_.size()
+    std::vector<std::string> spare_packets_;
+    std::thread::id batch_owner_;
+    bool batch_open_;
+    bool batching_enabled_;
+    bool corked_;          // released by the loop thread once the output queue drains
+    bool tcp_nodelay_;
+
+    // Network loop
+    std::thread loop_thread_;
+    std::atomic<bool> loop_running_;
+    std::atomic<bool> disconnecting_;
+    void runLoop();
+
+    int pickLaneLocked();
+    bool dispatchesDirectlyLocked(Lane lane) const;
+    bool enqueueLocked(Lane lane, PackedMessage&& message, std::chrono::steady_clock::time_point now);
+    void recycleLocked(std::string& packet);
+    void setCork(bool corked);
+    bool dispatchLocked(Lane lane, const char* topic, const void* payload, size_t length);
+    void pumpLocked();
+
     // Callbacks
     std::function<void(int)> on_connect_callback_;
     std::function<void(int)> on_disconnect_callback_;
     std::function<void(int)> on_publish_callback_;
     // Message callback
     std::function<void(const std::string&, const std::string&)> on_message_callback_;
+    std::function<void(const char*, const void*, size_t)> on_raw_message_callback_;
 
     // Static callback functions for mosquitto
     static void onConnect(struct mosquitto* mosq, void* userdata, int rc);
@@ -0,0 +1,285 @@
+#include "nmea_parser.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kMaxFields = 24;
+constexpr double kKnotsToMps = 1852.0 / 3600.0;
+constexpr double kKmhToMps = 1000.0 / 3600.0;
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Plain decimal ("-12.345"); false for empty or malformed fields
+bool parseDecimal(std::string_view field, double& out) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < field.size() && (field[i] == '-' || field[i] == '+')) {
+        negative = field[i] == '-';
+        i++;
+    }
+    int64_t mantissa = 0;
+    int scale = 0;
+    bool digits = false;
+    bool fraction = false;
+    for (; i < field.size(); i++) {
+        char c = field[i];
+        if (c == '.' && !fraction) {
+            fraction = true;
+        } else if (c >= '0' && c <= '9') {
+            if (mantissa < 100000000000000000LL) {
+                mantissa = mantissa * 10 + (c - '0');
+                scale -= fraction ? 1 : 0;
+            } else if (!fraction) {
+                scale++;
+            }
+            digits = true;
+        } else {
+            return false;
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+    double value = static_cast<double>(mantissa);
+    if (scale != 0) {
+        value *= std::pow(10.0, scale);
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+bool parseInt(std::string_view field, int& out) {
+    double value;
+    if (!parseDecimal(field, value)) {
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+// "ddmm.mmmm" or "dddmm.mmmm" with an N/S/E/W hemisphere field
+bool parseCoordinate(std::string_view value, std::string_view hemisphere, double& out) {
+    double raw;
+    if (!parseDecimal(value, raw) || hemisphere.size() != 1) {
+        return false;
+    }
+    double degrees = std::floor(raw / 100.0);
+    double result = degrees + (raw - degrees * 100.0) / 60.0;
+    char h = hemisphere[0];
+    if (h == 'S' || h == 'W') {
+        result = -result;
+    } else if (h != 'N' && h != 'E') {
+        return false;
+    }
+    out = result;
+    return true;
+}
+
+// "hhmmss.sss" to milliseconds since midnight UTC
+bool parseTime(std::string_view field, uint32_t& out) {
+    double raw;
+    if (field.size() < 6 || !parseDecimal(field, raw)) {
+        return false;
+    }
+    uint32_t hhmmss = static_cast<uint32_t>(raw);
+    uint32_t ms = static_cast<uint32_t>(std::lround((raw - hhmmss) * 1000.0));
+    out = ((hhmmss / 10000) * 3600 + (hhmmss / 100 % 100) * 60 + hhmmss % 100) * 1000 + ms;
+    return true;
+}
+
+} // namespace
+
+NmeaParser::NmeaParser(double uere_m)
+    : uere_m_(uere_m)
+    , partial_size_(0)
+    , discarding_(false)
+{
+}
+
+size_t NmeaParser::feed(const char* data, size_t size) {
+    size_t updates = 0;
+    const char* p = data;
+    const char* end = data + size;
+
+    while (p < end) {
+        // Finish a line carried over from the previous read
+        if (partial_size_ > 0 || discarding_) {
+            const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            const char* stop = newline ? newline : end;
+            size_t length = stop - p;
+            if (!discarding_) {
+                if (partial_size_ + length > kMaxSentence) {
+                    stats_.overflows++;
+                    discarding_ = true;
+                    partial_size_ = 0;
+                } else {
+                    std::memcpy(partial_ + partial_size_, p, length);
+                    partial_size_ += length;
+                }
+            }
+            if (!newline) {
+                return updates;
+            }
+            if (!discarding_ && processSentence(partial_, partial_ + partial_size_)) {
+                updates++;
+            }
+            partial_size_ = 0;
+            discarding_ = false;
+            p = newline + 1;
+            continue;
+        }
+
+        const char* start = static_cast<const char*>(std::memchr(p, '$', end - p));
+        if (!start) {
+            return updates;
+        }
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', end - start));
+        if (!newline) {
+            // Sentence continues in the next read
+            size_t length = end - start;
+            if (length > kMaxSentence) {
+                stats_.overflows++;
+                discarding_ = true;
+            } else {
+                std::memcpy(partial_, start, length);
+                partial_size_ = length;
+            }
+            return updates;
+        }
+        if (static_cast<size_t>(newline - start) > kMaxSentence) {
+            stats_.overflows++;
+        } else if (processSentence(start, newline)) {
+            updates++;
+        }
+        p = newline + 1;
+    }
+    return updates;
+}
+
+bool NmeaParser::processSentence(const char* begin, const char* end) {
+    if (end > begin && end[-1] == '\r') {
+        end--;
+    }
+
+    // "$<body>*HH": XOR of every character between '$' and '*'
+    if (end - begin < 4 || begin[0] != '$' || end[-3] != '*') {
+        stats_.checksum_errors++;
+        return false;
+    }
+    const char* star = end - 3;
+    int high = hexValue(star[1]);
+    int low = hexValue(star[2]);
+    uint8_t checksum = 0;
+    for (const char* c = begin + 1; c < star; c++) {
+        checksum ^= static_cast<uint8_t>(*c);
+    }
+    if (high < 0 || low < 0 || checksum != ((high << 4) | low)) {
+        stats_.checksum_errors++;
+        return false;
+    }
+    stats_.sentences++;
+
+    // Split into fields in place
+    std::string_view fields[kMaxFields];
+    size_t count = 0;
+    const char* field = begin + 1;
+    for (const char* c = field; c <= star && count < kMaxFields; c++) {
+        if (c == star || *c == ',') {
+            fields[count++] = std::string_view(field, c - field);
+            field = c + 1;
+        }
+    }
+
+    // Address is a two-letter talker (GP, GN, GL, ...) and the sentence type
+    std::string_view address = fields[0];
+    if (address.size() != 5) {
+        stats_.ignored++;
+        return false;
+    }
+    std::string_view type = address.substr(2);
+    if (type == "GGA") {
+        return parseGga(fields, count);
+    } else if (type == "RMC") {
+        return parseRmc(fields, count);
+    } else if (type == "VTG") {
+        parseVtg(fields, count);
+        return false;
+    }
+    stats_.ignored++;
+    return false;
+}
+
+// $--GGA,time,lat,N,lon,E,quality,satellites,hdop,altitude,M,separation,M,age,station
+bool NmeaParser::parseGga(const std::string_view* fields, size_t count) {
+    if (count < 10) {
+        return false;
+    }
+    int quality = 0;
+    parseInt(fields[6], quality);
+    fix_.quality = quality;
+    if (quality == 0) {
+        fix_.valid = false;
+        return false;
+    }
+
+    double latitude, longitude;
+    if (!parseCoordinate(fields[2], fields[3], latitude) || !parseCoordinate(fields[4], fields[5], longitude)) {
+        return false;
+    }
+    fix_.latitude = latitude;
+    fix_.longitude = longitude;
+    parseTime(fields[1], fix_.time_of_day_ms);
+    parseInt(fields[7], fix_.satellites);
+    parseDecimal(fields[9], fix_.altitude);
+    if (parseDecimal(fields[8], fix_.hdop)) {
+        fix_.accuracy = fix_.hdop * uere_m_;
+    }
+    fix_.valid = true;
+    fix_.updates++;
+    return true;
+}
+
+// $--RMC,time,status,lat,N,lon,E,speed_knots,course,date,variation,E[,mode]
+bool NmeaParser::parseRmc(const std::string_view* fields, size_t count) {
+    if (count < 9) {
+        return false;
+    }
+    if (fields[2] != "A") {
+        fix_.valid = false;
+        return false;
+    }
+
+    double latitude, longitude;
+    if (!parseCoordinate(fields[3], fields[4], latitude) || !parseCoordinate(fields[5], fields[6], longitude)) {
+        return false;
+    }
+    fix_.latitude = latitude;
+    fix_.longitude = longitude;
+    parseTime(fields[1], fix_.time_of_day_ms);
+    double speed_knots;
+    if (parseDecimal(fields[7], speed_knots)) {
+        fix_.speed_mps = speed_knots * kKnotsToMps;
+    }
+    parseDecimal(fields[8], fix_.course_deg);
+    fix_.valid = true;
+    fix_.updates++;
+    return true;
+}
+
+// $--VTG,course,T,course_magnetic,M,speed_knots,N,speed_kmh,K[,mode]
+void NmeaParser::parseVtg(const std::string_view* fields, size_t count) {
+    if (count < 9) {
+        return;
+    }
+    parseDecimal(fields[1], fix_.course_deg);
+    double speed_kmh;
+    if (parseDecimal(fields[7], speed_kmh)) {
+        fix_.speed_mps = speed_kmh * kKmhToMps;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Position state assembled from GGA, RMC and VTG sentences
+struct GpsFix {
+    double latitude = 0.0;      // decimal degrees
+    double longitude = 0.0;     // decimal degrees
+    double altitude = 0.0;      // meters above mean sea level (GGA)
+    double hdop = 0.0;          // horizontal dilution of precision, 0 if not reported
+    double accuracy = 0.0;      // estimated horizontal error in meters, 0 if unknown
+    double speed_mps = 0.0;     // ground speed (RMC/VTG)
+    double course_deg = 0.0;    // true course over ground (RMC/VTG)
+    int quality = 0;            // GGA fix quality: 0 none, 1 GPS, 2 DGPS, 4/5 RTK
+    int satellites = 0;         // satellites used (GGA)
+    uint32_t time_of_day_ms = 0;  // UTC time of the last position sentence
+    bool valid = false;         // receiver currently reports a usable fix
+    uint64_t updates = 0;       // position updates so far
+};
+
+struct NmeaStats {
+    uint64_t sentences = 0;        // well-formed sentences with a matching checksum
+    uint64_t checksum_errors = 0;  // missing or mismatching checksum
+    uint64_t overflows = 0;        // lines longer than kMaxSentence, discarded
+    uint64_t ignored = 0;          // valid sentences of other types
+};
+
+// Incremental NMEA 0183 parser.
+//
+// feed() takes bytes exactly as read from the receiver, in any fragmentation.
+// Sentences that lie entirely inside one buffer are parsed in place; only a
+// sentence split across reads is carried over in a fixed internal buffer.
+// Nothing is allocated and numbers are parsed without the C locale.
+class NmeaParser {
+public:
+    // NMEA allows 82 characters; leave room for receivers that exceed it
+    static constexpr size_t kMaxSentence = 128;
+
+    // uere_m: user equivalent range error used to turn HDOP into meters
+    explicit NmeaParser(double uere_m = 4.0);
+
+    // Returns the number of sentences in data that updated the position
+    size_t feed(const char* data, size_t size);
+
+    const GpsFix& fix() const { return fix_; }
+    const NmeaStats& stats() const { return stats_; }
+
+private:
+    // [begin, end) spans one line from '$' up to, not including, '\n'
+    bool processSentence(const char* begin, const char* end);
+    bool parseGga(const std::string_view* fields, size_t count);
+    bool parseRmc(const std::string_view* fields, size_t count);
+    void parseVtg(const std::string_view* fields, size_t count);
+
+    double uere_m_;
+    GpsFix fix_;
+    NmeaStats stats_;
+
+    char partial_[kMaxSentence];
+    size_t partial_size_;
+    bool discarding_;  // inside an overlong line until the next '\n'
+};
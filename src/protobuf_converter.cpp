@@ -11,7 +11,7 @@ std::string ProtobufConverter::sensorDataToProtobuf(const SensorData& data, cons
     gps->set_latitude(data.gps_latitude);
     gps->set_longitude(data.gps_longitude);
     gps->set_altitude(data.gps_altitude);
-    gps->set_accuracy(5.0); // Default accuracy of 5 meters
+    gps->set_accuracy(data.gps_accuracy);
     
     std::string serialized;
     if (!msg.SerializeToString(&serialized)) {
@@ -60,7 +60,7 @@ std::string ProtobufConverter::gpsToProtobuf(const SensorData& data, const std::
     position->set_latitude(data.gps_latitude);
     position->set_longitude(data.gps_longitude);
     position->set_altitude(data.gps_altitude);
-    position->set_accuracy(5.0); // Default accuracy of 5 meters
+    position->set_accuracy(data.gps_accuracy);
     
     msg.set_unit("decimal_degrees");
     
@@ -73,6 +73,36 @@ std::string ProtobufConverter::gpsToProtobuf(const SensorData& data, const std::
     return serialized;
 }
 
+std::string ProtobufConverter::aggregateToProtobuf(const SensorAggregate& agg, const std::string& device_id) {
+    sensor::SensorAggregate msg;
+    msg.set_device_id(device_id);
+    msg.set_window_start(agg.window_start_ms);
+    msg.set_window_end(agg.window_end_ms);
+    msg.set_sample_count(agg.sample_count);
+    msg.set_temperature_min(agg.temperature_min);
+    msg.set_temperature_max(agg.temperature_max);
+    msg.set_temperature_mean(agg.temperature_mean);
+    msg.set_temperature_stddev(agg.temperature_stddev);
+    msg.set_temperature_p95(agg.temperature_p95);
+    msg.set_heading_mean(agg.heading_mean);
+    msg.set_heading_resultant(agg.heading_resultant);
+    msg.set_distance(agg.distance_m);
+    msg.set_version("1.0");
+
+    auto* position = msg.mutable_last_position();
+    position->set_latitude(agg.last_latitude);
+    position->set_longitude(agg.last_longitude);
+    position->set_altitude(agg.last_altitude);
+
+    std::string serialized;
+    if (!msg.SerializeToString(&serialized)) {
+        std::cerr << "Failed to serialize aggregate data to protobuf" << std::endl;
+        return "";
+    }
+
+    return serialized;
+}
+
 std::string ProtobufConverter::createOnlineStatus(const std::string& device_id) {
     sensor::StatusMessage msg;
     msg.set_status(sensor::StatusMessage::ONLINE);
@@ -121,11 +151,73 @@ std::string ProtobufConverter::createErrorStatus(const std::string& message, con
     return serialized;
 }
 
+std::string ProtobufConverter::createGovernorStatus(const GovernorReport& report, const std::string& device_id) {
+    sensor::StatusMessage msg;
+    msg.set_status(sensor::StatusMessage::ONLINE);
+    msg.set_device_id(device_id);
+    msg.set_timestamp(timestampToUnixMs(std::chrono::system_clock::now()));
+    msg.set_message(std::string("Sensor simulator online, governor ") + GovernorReport::levelName(report.level) +
+                    (report.reason.empty() ? "" : " (" + report.reason + ")"));
+
+    auto* governor = msg.mutable_governor();
+    governor->set_level(static_cast<sensor::GovernorState::Level>(report.level));
+    governor->set_cpu_usage(report.cpu_usage);
+    governor->set_cpu_budget(report.cpu_budget);
+    governor->set_memory_bytes(report.memory_bytes);
+    governor->set_memory_budget(report.memory_budget);
+    governor->set_throttled_periods(report.throttled_periods);
+    governor->set_decimation(report.decimation);
+    governor->set_reason(report.reason);
+    governor->set_publisher_cpu_usage(report.publisher_cpu_usage);
+    governor->set_temperature_decimation(report.temperature_decimation);
+    governor->set_compass_decimation(report.compass_decimation);
+    governor->set_gps_decimation(report.gps_decimation);
+
+    std::string serialized;
+    if (!msg.SerializeToString(&serialized)) {
+        std::cerr << "Failed to serialize governor status to protobuf" << std::endl;
+        return "";
+    }
+
+    return serialized;
+}
+
+void ProtobufConverter::appendHistoryBlock(sensor::HistoryChunk& chunk, const EncodedBlock& block, uint32_t column_mask) {
+    auto* msg = chunk.add_blocks();
+    msg->set_start_time(block.start_ms);
+    msg->set_end_time(block.end_ms);
+    msg->set_count(block.count);
+    msg->set_timestamps(block.timestamps);
+    msg->set_sequences(block.sequences);
+
+    size_t compressed = block.timestamps.size() + block.sequences.size();
+    uint32_t columns = 2;
+    for (int c = 0; c < kHistoryColumnCount; c++) {
+        if (column_mask & (1u << c)) {
+            auto* column = msg->add_columns();
+            column->set_name(historyColumnName(c));
+            column->set_data(block.columns[c]);
+            compressed += block.columns[c].size();
+            columns++;
+        }
+    }
+
+    chunk.set_raw_bytes(chunk.raw_bytes() + static_cast<uint64_t>(block.count) * columns * sizeof(uint64_t));
+    chunk.set_compressed_bytes(chunk.compressed_bytes() + compressed);
+}
+
 int64_t ProtobufConverter::timestampToUnixMs(const std::chrono::system_clock::time_point& timestamp) {
     auto duration = timestamp.time_since_epoch();
     return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
 }
 
+int64_t ProtobufConverter::monotonicNowNs() {
+    // steady_clock is CLOCK_MONOTONIC on Linux, so values are comparable
+    // between processes on the same host
+    auto duration = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
 bool ProtobufConverter::validateMessage(const std::string& serialized_data) {
     sensor::SensorData msg;
     return msg.ParseFromString(serialized_data);
@@ -138,16 +230,27 @@ void ProtobufConverter::setCommonFields(sensor::SensorData& msg, const SensorDat
     msg.set_timestamp(timestampToUnixMs(data.timestamp));
     msg.set_device_id(device_id);
     msg.set_version("1.0");
+    msg.set_sequence(data.sequence);
+    msg.set_send_time_ns(monotonicNowNs());
 }
 
 void ProtobufConverter::setCommonFields(sensor::TemperatureData& msg, const SensorData& data, const std::string& device_id) {
     msg.set_timestamp(timestampToUnixMs(data.timestamp));
+    msg.set_sequence(data.sequence);
+    msg.set_send_time_ns(monotonicNowNs());
+    msg.set_device_id(device_id);
 }
 
 void ProtobufConverter::setCommonFields(sensor::CompassData& msg, const SensorData& data, const std::string& device_id) {
     msg.set_timestamp(timestampToUnixMs(data.timestamp));
+    msg.set_sequence(data.sequence);
+    msg.set_send_time_ns(monotonicNowNs());
+    msg.set_device_id(device_id);
 }
 
 void ProtobufConverter::setCommonFields(sensor::GpsPositionData& msg, const SensorData& data, const std::string& device_id) {
     msg.set_timestamp(timestampToUnixMs(data.timestamp));
+    msg.set_sequence(data.sequence);
+    msg.set_send_time_ns(monotonicNowNs());
+    msg.set_device_id(device_id);
 } 
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "sensor_simulator.h"
+#include "sensor_aggregator.h"
+#include "rate_governor.h"
+#include "history_store.h"
 #include "sensor.pb.h"
 #include <string>
 #include <memory>
@@ -15,14 +18,23 @@ public:
     static std::string temperatureToProtobuf(const SensorData& data, const std::string& device_id = "imx8mp_sensor");
     static std::string compassToProtobuf(const SensorData& data, const std::string& device_id = "imx8mp_sensor");
     static std::string gpsToProtobuf(const SensorData& data, const std::string& device_id = "imx8mp_sensor");
+    static std::string aggregateToProtobuf(const SensorAggregate& agg, const std::string& device_id = "imx8mp_sensor");
     
     // Create status messages
     static std::string createOnlineStatus(const std::string& device_id = "imx8mp_sensor");
     static std::string createOfflineStatus(const std::string& device_id = "imx8mp_sensor");
     static std::string createErrorStatus(const std::string& message, const std::string& device_id = "imx8mp_sensor");
+    // Online status carrying the rate governor's current level and usage
+    static std::string createGovernorStatus(const GovernorReport& report, const std::string& device_id = "imx8mp_sensor");
+
+    // Append a compressed history block to a chunk, keeping the columns in column_mask
+    static void appendHistoryBlock(sensor::HistoryChunk& chunk, const EncodedBlock& block, uint32_t column_mask);
     
     // Convert timestamp to Unix milliseconds
     static int64_t timestampToUnixMs(const std::chrono::system_clock::time_point& timestamp);
+
+    // Current CLOCK_MONOTONIC time in nanoseconds, used as the send timestamp
+    static int64_t monotonicNowNs();
     
     // Validate protobuf message
     static bool validateMessage(const std::string& serialized_data);
@@ -0,0 +1,328 @@
+#include "rate_governor.h"
+#include "sensor_aggregator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+// First whitespace-separated token of a small pseudo-file
+bool readToken(const std::string& path, std::string& token) {
+    std::ifstream file(path);
+    return static_cast<bool>(file >> token);
+}
+
+// "max" or anything unparseable reads as no limit
+bool readUint(const std::string& path, uint64_t& value) {
+    std::string token;
+    if (!readToken(path, token) || token == "max") {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(token.c_str(), &end, 10);
+    if (end == token.c_str() || *end != '\0' || errno == ERANGE || token[0] == '-') {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+int64_t clockNs(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+int64_t processCpuNs() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    auto toNs = [](const timeval& tv) {
+        return static_cast<int64_t>(tv.tv_sec) * 1000000000 + static_cast<int64_t>(tv.tv_usec) * 1000;
+    };
+    return toNs(usage.ru_utime) + toNs(usage.ru_stime);
+}
+
+uint64_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+std::string formatUsage(const char* what, double used, double budget, const char* unit, double scale) {
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "%s %.1f%s of %.1f%s", what, used * scale, unit, budget * scale, unit);
+    return buf;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// CgroupBudget
+// ---------------------------------------------------------------------------
+bool CgroupBudget::discover() {
+    path_.clear();
+
+    std::ifstream cgroup("/proc/self/cgroup");
+    std::string line;
+    std::string relative;
+    while (std::getline(cgroup, line)) {
+        // The v2 entry is "0::<path>"
+        if (line.compare(0, 3, "0::") == 0) {
+            relative = line.substr(3);
+            break;
+        }
+    }
+    if (relative.empty()) {
+        return false;
+    }
+
+    // Pure v2 mounts at /sys/fs/cgroup; hybrid systems under unified/
+    for (const char* root : {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}) {
+        std::string candidate = std::string(root) + (relative == "/" ? "" : relative);
+        if (std::ifstream(candidate + "/cgroup.procs")) {
+            path_ = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+double CgroupBudget::cpuLimit() const {
+    if (path_.empty()) {
+        return 0.0;
+    }
+    // "<quota> <period>" in microseconds, or "max <period>"
+    std::ifstream file(path_ + "/cpu.max");
+    std::string quota;
+    double period = 0.0;
+    if (!(file >> quota >> period) || quota == "max" || period <= 0.0) {
+        return 0.0;
+    }
+    char* end = nullptr;
+    double limit = std::strtod(quota.c_str(), &end);
+    if (end == quota.c_str() || *end != '\0' || !(limit > 0.0)) {
+        return 0.0;
+    }
+    return limit / period;
+}
+
+uint64_t CgroupBudget::memoryLimit() const {
+    if (path_.empty()) {
+        return 0;
+    }
+    uint64_t max = 0, high = 0;
+    bool has_max = readUint(path_ + "/memory.max", max);
+    bool has_high = readUint(path_ + "/memory.high", high);
+    if (has_max && has_high) {
+        return std::min(max, high);
+    }
+    return has_max ? max : (has_high ? high : 0);
+}
+
+bool CgroupBudget::readCpuStat(uint64_t& usage_usec, uint64_t& nr_throttled) const {
+    if (path_.empty()) {
+        return false;
+    }
+    std::ifstream file(path_ + "/cpu.stat");
+    std::string key;
+    uint64_t value;
+    bool has_usage = false;
+    nr_throttled = 0;
+    while (file >> key >> value) {
+        if (key == "usage_usec") {
+            usage_usec = value;
+            has_usage = true;
+        } else if (key == "nr_throttled") {
+            nr_throttled = value;
+        }
+    }
+    return has_usage;
+}
+
+bool CgroupBudget::readMemoryCurrent(uint64_t& bytes) const {
+    return !path_.empty() && readUint(path_ + "/memory.current", bytes);
+}
+
+// ---------------------------------------------------------------------------
+// GovernorReport
+// ---------------------------------------------------------------------------
+const char* GovernorReport::levelName(Level level) {
+    switch (level) {
+        case kNormal: return "normal";
+        case kReduced: return "reduced";
+        case kDeadband: return "deadband";
+    }
+    return "unknown";
+}
+
+// ---------------------------------------------------------------------------
+// RateGovernor
+// ---------------------------------------------------------------------------
+RateGovernor::RateGovernor(const GovernorConfig& config)
+    : config_(config)
+    , level_(GovernorReport::kNormal)
+    , last_process_cpu_ns_(0)
+    , last_thread_cpu_ns_(0)
+    , last_throttled_(0)
+    , calm_intervals_(0)
+{
+}
+
+void RateGovernor::start() {
+    cgroup_.discover();
+
+    std::lock_guard<std::mutex> lock(report_mutex_);
+    report_.cpu_budget = config_.cpu_budget > 0.0 ? config_.cpu_budget : cgroup_.cpuLimit();
+    report_.memory_budget = config_.memory_budget > 0 ? config_.memory_budget : cgroup_.memoryLimit();
+    report_.reason = "started";
+
+    last_eval_ = std::chrono::steady_clock::now();
+    uint64_t usage_usec = 0;
+    if (cgroup_.readCpuStat(usage_usec, last_throttled_)) {
+        last_process_cpu_ns_ = static_cast<int64_t>(usage_usec) * 1000;
+    } else {
+        last_process_cpu_ns_ = processCpuNs();
+    }
+    last_thread_cpu_ns_ = clockNs(CLOCK_THREAD_CPUTIME_ID);
+}
+
+bool RateGovernor::update(std::chrono::steady_clock::time_point now) {
+    if (now - last_eval_ < std::chrono::milliseconds(config_.interval_ms)) {
+        return false;
+    }
+    double wall_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_eval_).count());
+    last_eval_ = now;
+
+    // CPU: the cgroup counter covers every thread the quota applies to
+    int64_t process_cpu_ns;
+    uint64_t usage_usec = 0, throttled = 0, throttled_delta = 0;
+    if (cgroup_.readCpuStat(usage_usec, throttled)) {
+        process_cpu_ns = static_cast<int64_t>(usage_usec) * 1000;
+        throttled_delta = throttled - last_throttled_;
+        last_throttled_ = throttled;
+    } else {
+        process_cpu_ns = processCpuNs();
+    }
+    int64_t thread_cpu_ns = clockNs(CLOCK_THREAD_CPUTIME_ID);
+
+    uint64_t memory_bytes = 0;
+    if (!cgroup_.readMemoryCurrent(memory_bytes)) {
+        memory_bytes = residentBytes();
+    }
+
+    GovernorReport::Level previous = level_;
+    {
+        std::lock_guard<std::mutex> lock(report_mutex_);
+        report_.cpu_usage = (process_cpu_ns - last_process_cpu_ns_) / wall_ns;
+        report_.publisher_cpu_usage = (thread_cpu_ns - last_thread_cpu_ns_) / wall_ns;
+        report_.memory_bytes = memory_bytes;
+        report_.throttled_periods = throttled_delta;
+    }
+    last_process_cpu_ns_ = process_cpu_ns;
+    last_thread_cpu_ns_ = thread_cpu_ns;
+
+    GovernorReport current = snapshot();
+    double cpu_share = current.cpu_budget > 0.0 ? current.cpu_usage / current.cpu_budget : 0.0;
+    double memory_share = current.memory_budget > 0
+        ? static_cast<double>(current.memory_bytes) / current.memory_budget : 0.0;
+
+    if (throttled_delta > 0 || cpu_share > config_.high_watermark || memory_share > config_.high_watermark) {
+        calm_intervals_ = 0;
+        if (level_ < GovernorReport::kDeadband) {
+            std::string reason;
+            if (throttled_delta > 0) {
+                reason = "throttled for " + std::to_string(throttled_delta) + " periods";
+            } else if (cpu_share > config_.high_watermark) {
+                reason = formatUsage("cpu", current.cpu_usage, current.cpu_budget, "%", 100.0);
+            } else {
+                reason = formatUsage("memory", static_cast<double>(current.memory_bytes),
+                                     static_cast<double>(current.memory_budget), "MiB", 1.0 / (1024 * 1024));
+            }
+            setLevel(static_cast<GovernorReport::Level>(level_ + 1), reason);
+        }
+    } else if (cpu_share < config_.low_watermark && memory_share < config_.low_watermark) {
+        if (level_ > GovernorReport::kNormal && ++calm_intervals_ >= config_.hold_intervals) {
+            calm_intervals_ = 0;
+            setLevel(static_cast<GovernorReport::Level>(level_ - 1), "headroom restored");
+        }
+    } else {
+        calm_intervals_ = 0;
+    }
+
+    return level_ != previous;
+}
+
+void RateGovernor::setLevel(GovernorReport::Level level, const std::string& reason) {
+    level_ = level;
+    std::lock_guard<std::mutex> lock(report_mutex_);
+    report_.level = level;
+    bool normal = level == GovernorReport::kNormal;
+    report_.decimation = normal ? 1 : decimation(kAll);
+    report_.temperature_decimation = normal ? 1 : decimation(kTemperature);
+    report_.compass_decimation = normal ? 1 : decimation(kCompass);
+    report_.gps_decimation = normal ? 1 : decimation(kGps);
+    report_.reason = reason;
+}
+
+bool RateGovernor::admit(Channel channel, const SensorData& data) {
+    ChannelState& state = channels_[channel];
+
+    if (level_ != GovernorReport::kNormal) {
+        if (++state.skipped < decimation(channel)) {
+            return false;
+        }
+        state.skipped = 0;
+
+        if (level_ == GovernorReport::kDeadband && state.published &&
+            data.timestamp - state.last.timestamp < std::chrono::milliseconds(config_.max_silence_ms) &&
+            !changedBeyondDeadband(channel, state.last, data)) {
+            return false;
+        }
+    }
+
+    // Remember what was last sent so the dead-band compares against it
+    state.published = true;
+    state.last = data;
+    return true;
+}
+
+uint32_t RateGovernor::decimation(Channel channel) const {
+    uint32_t n = config_.all_decimation;
+    switch (channel) {
+        case kTemperature: n = config_.temperature_decimation; break;
+        case kCompass: n = config_.compass_decimation; break;
+        case kGps: n = config_.gps_decimation; break;
+        default: break;
+    }
+    return std::max<uint32_t>(1, n);
+}
+
+bool RateGovernor::changedBeyondDeadband(Channel channel, const SensorData& last, const SensorData& data) const {
+    bool temperature = std::fabs(data.cpu_temperature - last.cpu_temperature) >= config_.temperature_deadband;
+
+    double heading_delta = std::fabs(data.compass_heading - last.compass_heading);
+    bool heading = std::min(heading_delta, 360.0 - heading_delta) >= config_.heading_deadband;
+
+    bool position = SensorAggregator::distanceMeters(last.gps_latitude, last.gps_longitude,
+                                                     data.gps_latitude, data.gps_longitude) >= config_.position_deadband_m;
+
+    switch (channel) {
+        case kTemperature: return temperature;
+        case kCompass: return heading;
+        case kGps: return position;
+        default: return temperature || heading || position;
+    }
+}
+
+GovernorReport RateGovernor::snapshot() const {
+    std::lock_guard<std::mutex> lock(report_mutex_);
+    return report_;
+}
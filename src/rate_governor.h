@@ -0,0 +1,139 @@
+#pragma once
+
+#include "sensor_simulator.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Limits and usage of the cgroup (v2) the process runs in. Under systemd this
+// is the service's own cgroup, so CPUQuota= and MemoryMax= show up here as
+// cpu.max and memory.max.
+class CgroupBudget {
+public:
+    // Locates /sys/fs/cgroup/<path> from /proc/self/cgroup; false outside a v2 hierarchy
+    bool discover();
+    bool available() const { return !path_.empty(); }
+    const std::string& path() const { return path_; }
+
+    // Fraction of one CPU allowed by cpu.max; 0 if unlimited
+    double cpuLimit() const;
+    // memory.max (or the lower memory.high) in bytes; 0 if unlimited
+    uint64_t memoryLimit() const;
+
+    bool readCpuStat(uint64_t& usage_usec, uint64_t& nr_throttled) const;
+    bool readMemoryCurrent(uint64_t& bytes) const;
+
+private:
+    std::string path_;
+};
+
+struct GovernorConfig {
+    double cpu_budget = 0.0;          // fraction of one CPU; 0 takes cpu.max
+    uint64_t memory_budget = 0;       // bytes; 0 takes memory.max
+    double high_watermark = 0.85;     // degrade one level above this share of a budget
+    double low_watermark = 0.60;      // restore one level below this share...
+    int hold_intervals = 3;           // ...sustained for this many intervals
+    int64_t interval_ms = 1000;       // evaluation period
+    // Publish every Nth tick per channel when degraded. Temperature drifts
+    // slowly and is cut deepest; GPS and compass track motion and keep more.
+    uint32_t all_decimation = 4;          // sensor/all
+    uint32_t temperature_decimation = 8;
+    uint32_t compass_decimation = 2;
+    uint32_t gps_decimation = 2;
+    double temperature_deadband = 0.5;   // Celsius
+    double heading_deadband = 2.0;       // degrees
+    double position_deadband_m = 1.0;    // meters
+    int64_t max_silence_ms = 10000;   // dead-band keepalive per channel
+};
+
+// Snapshot of the governor's last evaluation
+struct GovernorReport {
+    enum Level {
+        kNormal = 0,    // every channel published each tick
+        kReduced = 1,   // channels decimated
+        kDeadband = 2,  // decimated and published only on significant change
+    };
+
+    Level level = kNormal;
+    double cpu_usage = 0.0;          // fraction of one CPU, whole process or cgroup
+    double publisher_cpu_usage = 0.0;  // fraction of one CPU, thread calling update() only
+    double cpu_budget = 0.0;
+    uint64_t memory_bytes = 0;
+    uint64_t memory_budget = 0;
+    uint64_t throttled_periods = 0;  // during the last interval
+    uint32_t decimation = 1;         // sensor/all publishes every Nth tick
+    uint32_t temperature_decimation = 1;
+    uint32_t compass_decimation = 1;
+    uint32_t gps_decimation = 1;
+    std::string reason;
+
+    static const char* levelName(Level level);
+};
+
+// Keeps the publishing load inside the process's CPU and memory budget.
+//
+// update() runs on the publishing thread once per tick and re-evaluates usage
+// every interval_ms: CPU time from cgroup cpu.stat (getrusage outside a
+// cgroup), the publishing thread's own time from CLOCK_THREAD_CPUTIME_ID and
+// memory from memory.current (resident set size outside a cgroup). Without
+// --rt that thread also samples; with --rt the sampler's time is only part
+// of the process total. Any CFS
+// throttling or usage above the high watermark degrades one level; sustained
+// usage below the low watermark restores one level.
+//
+// admit() applies the current level per channel. Sampling itself continues at
+// full rate, so the aggregator and the shared-memory ring are unaffected.
+class RateGovernor {
+public:
+    enum Channel {
+        kAll = 0,
+        kTemperature,
+        kCompass,
+        kGps,
+        kChannelCount
+    };
+
+    explicit RateGovernor(const GovernorConfig& config = GovernorConfig());
+
+    // Resolves the budgets and takes the usage baseline; call from the thread that calls update()
+    void start();
+
+    // Returns true when the level changed during this call
+    bool update(std::chrono::steady_clock::time_point now);
+
+    // Whether `data` should be published on `channel` at the current level
+    bool admit(Channel channel, const SensorData& data);
+
+    GovernorReport::Level level() const { return level_; }
+
+    // Thread-safe copy of the last evaluation
+    GovernorReport snapshot() const;
+
+private:
+    struct ChannelState {
+        uint32_t skipped = 0;
+        bool published = false;
+        SensorData last;
+    };
+
+    uint32_t decimation(Channel channel) const;
+    bool changedBeyondDeadband(Channel channel, const SensorData& last, const SensorData& data) const;
+    void setLevel(GovernorReport::Level level, const std::string& reason);
+
+    GovernorConfig config_;
+    CgroupBudget cgroup_;
+    GovernorReport::Level level_;
+    std::array<ChannelState, kChannelCount> channels_;
+
+    // Usage baseline of the previous evaluation
+    std::chrono::steady_clock::time_point last_eval_;
+    int64_t last_process_cpu_ns_;
+    int64_t last_thread_cpu_ns_;
+    uint64_t last_throttled_;
+    int calm_intervals_;
+
+    mutable std::mutex report_mutex_;
+    GovernorReport report_;
+};
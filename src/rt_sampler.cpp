@@ -0,0 +1,249 @@
+#include "rt_sampler.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <system_error>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kPrefaultStackBytes = 256 * 1024;
+
+int64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+timespec toTimespec(int64_t ns) {
+    timespec ts;
+    ts.tv_sec = ns / 1000000000;
+    ts.tv_nsec = ns % 1000000000;
+    return ts;
+}
+
+// Touches the top of the stack so the pages are resident (and locked) before
+// the first tick instead of faulting in on it
+void prefaultStack() {
+    char buffer[kPrefaultStackBytes];
+    std::memset(buffer, 0, sizeof(buffer));
+    asm volatile("" : : "r"(buffer) : "memory");  // keep the writes
+}
+
+std::string errnoText(const char* what, int err) {
+    return std::string(what) + ": " + std::strerror(err);
+}
+
+template <size_t N>
+double percentileUs(const std::array<uint32_t, N>& bins, uint64_t total, double p) {
+    if (total == 0) return 0.0;
+    uint64_t rank = static_cast<uint64_t>(p * (total - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bins.size(); i++) {
+        seen += bins[i];
+        if (seen > rank) return static_cast<double>(i);
+    }
+    return static_cast<double>(bins.size() - 1);
+}
+
+} // namespace
+
+RtSampler::RtSampler(SensorSimulator& simulator, std::chrono::nanoseconds period, const RtConfig& config)
+    : simulator_(simulator)
+    , period_(period)
+    , config_(config)
+    , queue_(config.queue_capacity)
+    , event_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , running_(false)
+    , go_(false)
+    , realtime_(false)
+    , ticks_(0)
+    , overruns_(0)
+    , dropped_(0)
+    , max_period_error_ns_(0)
+    , max_lateness_ns_(0)
+    , last_bins_{}
+    , last_ticks_(0)
+    , last_overruns_(0)
+    , last_dropped_(0)
+{
+    for (auto& bin : bins_) {
+        bin.store(0, std::memory_order_relaxed);
+    }
+}
+
+RtSampler::~RtSampler() {
+    stop();
+    if (event_fd_ >= 0) {
+        close(event_fd_);
+    }
+}
+
+bool RtSampler::start() {
+    if (running_) {
+        return true;
+    }
+    if (event_fd_ < 0) {
+        warnings_.push_back(errnoText("eventfd", errno));
+        return false;
+    }
+
+    // Lock everything mapped so far. Future mappings are only locked when the
+    // limit allows it; otherwise later allocations on other threads could fail.
+    if (config_.lock_memory) {
+        rlimit limit;
+        bool unlimited = geteuid() == 0 ||
+            (getrlimit(RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur == RLIM_INFINITY);
+        int flags = unlimited ? (MCL_CURRENT | MCL_FUTURE) : MCL_CURRENT;
+        if (mlockall(flags) != 0) {
+            warnings_.push_back(errnoText("mlockall", errno) + ", memory not locked");
+        } else if (!unlimited) {
+            warnings_.push_back("RLIMIT_MEMLOCK is limited, only current mappings locked");
+        }
+    }
+
+    running_ = true;
+    go_ = false;
+    try {
+        thread_ = std::thread(&RtSampler::run, this);
+    } catch (const std::system_error& e) {
+        running_ = false;
+        warnings_.push_back(std::string("sampling thread: ") + e.what());
+        return false;
+    }
+
+    sched_param param{};
+    param.sched_priority = std::clamp(config_.priority, sched_get_priority_min(SCHED_FIFO),
+                                      sched_get_priority_max(SCHED_FIFO));
+    int rc = pthread_setschedparam(thread_.native_handle(), SCHED_FIFO, &param);
+    if (rc == 0) {
+        realtime_ = true;
+    } else {
+        warnings_.push_back(errnoText("SCHED_FIFO", rc) + ", sampling at normal priority");
+    }
+
+    if (config_.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(config_.cpu, &set);
+        rc = pthread_setaffinity_np(thread_.native_handle(), sizeof(set), &set);
+        if (rc != 0) {
+            warnings_.push_back(errnoText(("affinity to CPU " + std::to_string(config_.cpu)).c_str(), rc) +
+                                ", thread not pinned");
+        }
+    }
+
+    go_.store(true, std::memory_order_release);
+    return true;
+}
+
+void RtSampler::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    go_.store(true, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void RtSampler::run() {
+    // Scheduling and affinity are applied by start() before this releases
+    while (!go_.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    prefaultStack();
+
+    const int64_t period_ns = period_.count();
+    const uint64_t one = 1;
+    int64_t deadline = monotonicNs() + period_ns;
+    int64_t previous_wake = 0;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        timespec ts = toTimespec(deadline);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+
+        int64_t wake = monotonicNs();
+        if (previous_wake != 0) {
+            record(std::abs(wake - previous_wake - period_ns), wake - deadline);
+        }
+        previous_wake = wake;
+
+        if (!queue_.push(simulator_.generateSensorData())) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        ssize_t written = write(event_fd_, &one, sizeof(one));
+        (void)written;  // EAGAIN only when the counter saturates; the consumer is already due
+
+        deadline += period_ns;
+        if (deadline <= wake) {
+            // Missed at least one whole period: resynchronize instead of bursting
+            overruns_.fetch_add(1, std::memory_order_relaxed);
+            deadline = wake + period_ns;
+        }
+    }
+}
+
+void RtSampler::record(int64_t period_error_ns, int64_t lateness_ns) {
+    size_t bin = std::min<size_t>(static_cast<size_t>(period_error_ns / 1000), kBins - 1);
+    bins_[bin].fetch_add(1, std::memory_order_relaxed);
+    ticks_.fetch_add(1, std::memory_order_relaxed);
+
+    // Single writer; a concurrent reset by takeStats() may carry a maximum
+    // into the next interval, which is harmless
+    if (period_error_ns > max_period_error_ns_.load(std::memory_order_relaxed)) {
+        max_period_error_ns_.store(period_error_ns, std::memory_order_relaxed);
+    }
+    if (lateness_ns > max_lateness_ns_.load(std::memory_order_relaxed)) {
+        max_lateness_ns_.store(lateness_ns, std::memory_order_relaxed);
+    }
+}
+
+bool RtSampler::waitForData(int timeout_ms) {
+    pollfd pfd{event_fd_, POLLIN, 0};
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return false;
+    }
+    uint64_t count;
+    ssize_t n = read(event_fd_, &count, sizeof(count));
+    return n == sizeof(count);
+}
+
+JitterStats RtSampler::takeStats() {
+    std::array<uint32_t, kBins> delta;
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBins; i++) {
+        uint32_t now = bins_[i].load(std::memory_order_relaxed);
+        delta[i] = now - last_bins_[i];
+        last_bins_[i] = now;
+        total += delta[i];
+    }
+
+    JitterStats stats;
+    uint64_t ticks = ticks_.load(std::memory_order_relaxed);
+    uint64_t overruns = overruns_.load(std::memory_order_relaxed);
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    stats.ticks = ticks - last_ticks_;
+    stats.overruns = overruns - last_overruns_;
+    stats.dropped = dropped - last_dropped_;
+    last_ticks_ = ticks;
+    last_overruns_ = overruns;
+    last_dropped_ = dropped;
+
+    stats.period_p50_us = percentileUs(delta, total, 0.50);
+    stats.period_p99_us = percentileUs(delta, total, 0.99);
+    stats.period_p999_us = percentileUs(delta, total, 0.999);
+    stats.period_max_us = max_period_error_ns_.exchange(0, std::memory_order_relaxed) / 1000.0;
+    stats.wake_max_us = max_lateness_ns_.exchange(0, std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "sensor_simulator.h"
+#include "spsc_queue.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct RtConfig {
+    int priority = 50;             // SCHED_FIFO priority (1-99)
+    int cpu = -1;                  // pin the sampling thread to this CPU; -1 leaves it unpinned
+    bool lock_memory = true;       // mlockall before sampling starts
+    size_t queue_capacity = 4096;  // samples buffered towards the publishing thread
+};
+
+// Tick timing over one reporting interval
+struct JitterStats {
+    uint64_t ticks = 0;
+    uint64_t overruns = 0;        // ticks woken more than a full period late
+    uint64_t dropped = 0;         // samples lost because the queue was full
+    double period_p50_us = 0.0;   // |actual period - nominal period|
+    double period_p99_us = 0.0;
+    double period_p999_us = 0.0;
+    double period_max_us = 0.0;
+    double wake_max_us = 0.0;     // worst lateness against the absolute deadline
+};
+
+// Samples the simulator on a dedicated real-time thread.
+//
+// start() locks memory, creates the thread and asks for SCHED_FIFO and the
+// requested affinity. Each of those that the process is not permitted to do
+// is recorded in warnings() and sampling continues without it, so the mode
+// also runs unprivileged. The thread pre-faults its stack, then sleeps on
+// absolute CLOCK_MONOTONIC deadlines. Each tick it generates one sample,
+// pushes it onto a preallocated SPSC queue and signals an eventfd. It never
+// allocates, locks or logs. Publishing stays on the consumer thread.
+class RtSampler {
+public:
+    RtSampler(SensorSimulator& simulator, std::chrono::nanoseconds period, const RtConfig& config = RtConfig());
+    ~RtSampler();
+
+    // False only if the sampling thread could not be created
+    bool start();
+    void stop();
+
+    // Consumer side: waits up to timeout_ms for samples, then drains with pop()
+    bool waitForData(int timeout_ms);
+    bool pop(SensorData& out) { return queue_.pop(out); }
+
+    // Statistics since the previous call; consumer thread only
+    JitterStats takeStats();
+
+    bool realtime() const { return realtime_; }
+    const std::vector<std::string>& warnings() const { return warnings_; }
+
+private:
+    // Period error histogram: 1 us bins up to kBins us, the last bin is overflow
+    static constexpr size_t kBins = 4096;
+
+    void run();
+    void record(int64_t period_error_ns, int64_t lateness_ns);
+
+    SensorSimulator& simulator_;
+    std::chrono::nanoseconds period_;
+    RtConfig config_;
+    SpscQueue<SensorData> queue_;
+    int event_fd_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> go_;
+    bool realtime_;
+    std::vector<std::string> warnings_;
+
+    // Written by the sampling thread, read by takeStats()
+    std::array<std::atomic<uint32_t>, kBins> bins_;
+    std::atomic<uint64_t> ticks_;
+    std::atomic<uint64_t> overruns_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<int64_t> max_period_error_ns_;
+    std::atomic<int64_t> max_lateness_ns_;
+
+    // Consumer's copy of the counters at the previous takeStats()
+    std::array<uint32_t, kBins> last_bins_;
+    uint64_t last_ticks_;
+    uint64_t last_overruns_;
+    uint64_t last_dropped_;
+};
@@ -0,0 +1,228 @@
+#include "sensor_aggregator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kDegToRad = M_PI / 180.0;
+constexpr double kEarthRadiusM = 6371000.0;
+
+int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// HistogramSketch
+// ---------------------------------------------------------------------------
+HistogramSketch::HistogramSketch(double lo, double hi)
+    : lo_(lo)
+    , width_((hi > lo ? hi - lo : 1.0) / kBins)
+    , total_(0)
+    , bins_{}
+{
+}
+
+void HistogramSketch::add(double value) {
+    int bin = static_cast<int>((value - lo_) / width_);
+    bins_[std::clamp(bin, 0, kBins - 1)]++;
+    total_++;
+}
+
+void HistogramSketch::merge(const HistogramSketch& other) {
+    for (int i = 0; i < kBins; i++) {
+        bins_[i] += other.bins_[i];
+    }
+    total_ += other.total_;
+}
+
+void HistogramSketch::clear() {
+    bins_.fill(0);
+    total_ = 0;
+}
+
+double HistogramSketch::quantile(double q, double observed_min, double observed_max) const {
+    if (total_ == 0) {
+        return 0.0;
+    }
+    double target = q * total_;
+    double cumulative = 0.0;
+    for (int i = 0; i < kBins; i++) {
+        if (bins_[i] == 0) continue;
+        if (cumulative + bins_[i] >= target) {
+            // Interpolate linearly within the bin
+            double fraction = (target - cumulative) / bins_[i];
+            double value = lo_ + (i + fraction) * width_;
+            return std::clamp(value, observed_min, observed_max);
+        }
+        cumulative += bins_[i];
+    }
+    return observed_max;
+}
+
+// ---------------------------------------------------------------------------
+// WindowAccumulator
+// ---------------------------------------------------------------------------
+void WindowAccumulator::add(const SensorData& data, double step_distance_m) {
+    count++;
+
+    double t = data.cpu_temperature;
+    double delta = t - temp_mean;
+    temp_mean += delta / count;
+    temp_m2 += delta * (t - temp_mean);
+    if (count == 1) {
+        temp_min = temp_max = t;
+    } else {
+        temp_min = std::min(temp_min, t);
+        temp_max = std::max(temp_max, t);
+    }
+    temp_sketch.add(t);
+
+    heading_sin += std::sin(data.compass_heading * kDegToRad);
+    heading_cos += std::cos(data.compass_heading * kDegToRad);
+
+    distance_m += step_distance_m;
+    last_lat = data.gps_latitude;
+    last_lon = data.gps_longitude;
+    last_alt = data.gps_altitude;
+}
+
+void WindowAccumulator::merge(const WindowAccumulator& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+
+    // Chan et al. parallel combination of Welford states
+    double n_a = count;
+    double n_b = other.count;
+    double n = n_a + n_b;
+    double delta = other.temp_mean - temp_mean;
+    temp_mean += delta * n_b / n;
+    temp_m2 += other.temp_m2 + delta * delta * n_a * n_b / n;
+    temp_min = std::min(temp_min, other.temp_min);
+    temp_max = std::max(temp_max, other.temp_max);
+    temp_sketch.merge(other.temp_sketch);
+    count += other.count;
+
+    heading_sin += other.heading_sin;
+    heading_cos += other.heading_cos;
+
+    // Panes are merged oldest first, so the other pane holds the newer fix
+    distance_m += other.distance_m;
+    last_lat = other.last_lat;
+    last_lon = other.last_lon;
+    last_alt = other.last_alt;
+}
+
+void WindowAccumulator::clear() {
+    count = 0;
+    temp_mean = temp_m2 = temp_min = temp_max = 0.0;
+    temp_sketch.clear();
+    heading_sin = heading_cos = 0.0;
+    distance_m = 0.0;
+    last_lat = last_lon = last_alt = 0.0;
+}
+
+// ---------------------------------------------------------------------------
+// SensorAggregator
+// ---------------------------------------------------------------------------
+SensorAggregator::SensorAggregator(int64_t window_ms, int64_t slide_ms, double temp_min, double temp_max)
+    : window_ms_(std::max<int64_t>(1, window_ms))
+    , slide_ms_(std::clamp<int64_t>(slide_ms, 1, window_ms_))
+    , current_pane_(-1)
+    , have_fix_(false)
+    , prev_lat_(0.0)
+    , prev_lon_(0.0)
+{
+    // A window spans a whole number of panes
+    window_ms_ = ((window_ms_ + slide_ms_ - 1) / slide_ms_) * slide_ms_;
+
+    WindowAccumulator empty;
+    empty.temp_sketch = HistogramSketch(temp_min, temp_max);
+    panes_.assign(static_cast<size_t>(window_ms_ / slide_ms_), empty);
+}
+
+bool SensorAggregator::addSample(const SensorData& data, SensorAggregate& out) {
+    int64_t ts = std::chrono::duration_cast<std::chrono::milliseconds>(
+        data.timestamp.time_since_epoch()).count();
+    int64_t pane = floorDiv(ts, slide_ms_);
+    int64_t num_panes = static_cast<int64_t>(panes_.size());
+    bool emitted = false;
+
+    if (current_pane_ < 0) {
+        current_pane_ = pane;
+    } else if (pane > current_pane_) {
+        // The sample opens a new pane, which closes the window ending here
+        int64_t window_end = (current_pane_ + 1) * slide_ms_;
+        fillAggregate(window_end, out);
+        emitted = out.sample_count > 0;
+
+        // Recycle the panes being entered; at most the whole ring
+        int64_t last_to_clear = std::min(pane, current_pane_ + num_panes);
+        for (int64_t p = current_pane_ + 1; p <= last_to_clear; p++) {
+            panes_[static_cast<size_t>(p % num_panes)].clear();
+        }
+        current_pane_ = pane;
+    }
+    // Late samples (pane < current_pane_) are folded into the current pane
+
+    double step = 0.0;
+    if (have_fix_) {
+        step = distanceMeters(prev_lat_, prev_lon_, data.gps_latitude, data.gps_longitude);
+    }
+    prev_lat_ = data.gps_latitude;
+    prev_lon_ = data.gps_longitude;
+    have_fix_ = true;
+
+    panes_[static_cast<size_t>(current_pane_ % num_panes)].add(data, step);
+    return emitted;
+}
+
+void SensorAggregator::fillAggregate(int64_t window_end_ms, SensorAggregate& out) const {
+    int64_t num_panes = static_cast<int64_t>(panes_.size());
+    WindowAccumulator total;
+    total.temp_sketch = panes_[0].temp_sketch;
+    total.temp_sketch.clear();
+    for (int64_t p = current_pane_ - num_panes + 1; p <= current_pane_; p++) {
+        if (p < 0) continue;
+        total.merge(panes_[static_cast<size_t>(p % num_panes)]);
+    }
+
+    out = SensorAggregate();
+    out.window_end_ms = window_end_ms;
+    out.window_start_ms = window_end_ms - window_ms_;
+    out.sample_count = total.count;
+    if (total.count == 0) {
+        return;
+    }
+
+    out.temperature_min = total.temp_min;
+    out.temperature_max = total.temp_max;
+    out.temperature_mean = total.temp_mean;
+    out.temperature_stddev = total.count > 1 ? std::sqrt(total.temp_m2 / (total.count - 1)) : 0.0;
+    out.temperature_p95 = total.temp_sketch.quantile(0.95, total.temp_min, total.temp_max);
+
+    double heading = std::atan2(total.heading_sin, total.heading_cos) / kDegToRad;
+    out.heading_mean = heading < 0.0 ? heading + 360.0 : heading;
+    out.heading_resultant = std::hypot(total.heading_sin, total.heading_cos) / total.count;
+
+    out.distance_m = total.distance_m;
+    out.last_latitude = total.last_lat;
+    out.last_longitude = total.last_lon;
+    out.last_altitude = total.last_alt;
+}
+
+double SensorAggregator::distanceMeters(double lat1, double lon1, double lat2, double lon2) {
+    double dlat = (lat2 - lat1) * kDegToRad;
+    double dlon = (lon2 - lon1) * kDegToRad;
+    double a = std::sin(dlat / 2) * std::sin(dlat / 2) +
+               std::cos(lat1 * kDegToRad) * std::cos(lat2 * kDegToRad) *
+               std::sin(dlon / 2) * std::sin(dlon / 2);
+    return 2.0 * kEarthRadiusM * std::asin(std::min(1.0, std::sqrt(a)));
+}
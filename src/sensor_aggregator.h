@@ -0,0 +1,104 @@
+#pragma once
+
+#include "sensor_simulator.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Result of one aggregation window
+struct SensorAggregate {
+    int64_t window_start_ms;     // inclusive, Unix milliseconds
+    int64_t window_end_ms;       // exclusive, Unix milliseconds
+    uint32_t sample_count;
+    double temperature_min;
+    double temperature_max;
+    double temperature_mean;
+    double temperature_stddev;
+    double temperature_p95;
+    double heading_mean;         // circular mean, degrees (0-360)
+    double heading_resultant;    // mean resultant length (0-1); 1 = no dispersion
+    double distance_m;           // great-circle distance travelled within the window
+    double last_latitude;
+    double last_longitude;
+    double last_altitude;
+};
+
+// Fixed-size, mergeable quantile sketch: an equal-width histogram over a
+// configured range. Values outside the range land in the edge bins, so the
+// estimate is exact to within one bin width (range / kBins).
+class HistogramSketch {
+public:
+    static constexpr int kBins = 128;
+
+    HistogramSketch(double lo = 0.0, double hi = 1.0);
+
+    void add(double value);
+    void merge(const HistogramSketch& other);
+    void clear();
+
+    // q in [0, 1]; result is clamped to [observed_min, observed_max]
+    double quantile(double q, double observed_min, double observed_max) const;
+
+private:
+    double lo_;
+    double width_;
+    uint64_t total_;
+    std::array<uint32_t, kBins> bins_;
+};
+
+// Running statistics for one pane; O(1) per sample and mergeable
+struct WindowAccumulator {
+    uint32_t count = 0;
+
+    // Temperature: Welford mean/variance plus extrema and quantile sketch
+    double temp_mean = 0.0;
+    double temp_m2 = 0.0;
+    double temp_min = 0.0;
+    double temp_max = 0.0;
+    HistogramSketch temp_sketch;
+
+    // Heading: unit-vector sums for the circular mean
+    double heading_sin = 0.0;
+    double heading_cos = 0.0;
+
+    // GPS: distance between consecutive fixes attributed to this pane
+    double distance_m = 0.0;
+    double last_lat = 0.0;
+    double last_lon = 0.0;
+    double last_alt = 0.0;
+
+    void add(const SensorData& data, double step_distance_m);
+    void merge(const WindowAccumulator& other);
+    void clear();
+};
+
+// Streaming tumbling/sliding window aggregation over SensorData.
+//
+// A window of window_ms advances every slide_ms (slide_ms == window_ms gives
+// tumbling windows). Samples land in panes of slide_ms, so each sample costs
+// O(1); closing a window merges window_ms / slide_ms panes.
+class SensorAggregator {
+public:
+    SensorAggregator(int64_t window_ms, int64_t slide_ms, double temp_min = 35.0, double temp_max = 85.0);
+
+    // Adds a sample. Returns true and fills `out` when the sample closes a
+    // window (the aggregate covers the window ending before this sample).
+    bool addSample(const SensorData& data, SensorAggregate& out);
+
+    int64_t windowMs() const { return window_ms_; }
+    int64_t slideMs() const { return slide_ms_; }
+
+    // Haversine distance in meters
+    static double distanceMeters(double lat1, double lon1, double lat2, double lon2);
+
+private:
+    void fillAggregate(int64_t window_end_ms, SensorAggregate& out) const;
+
+    int64_t window_ms_;
+    int64_t slide_ms_;
+    std::vector<WindowAccumulator> panes_;  // ring indexed by pane number
+    int64_t current_pane_;                  // pane number of the newest sample, -1 before the first
+    bool have_fix_;
+    double prev_lat_;
+    double prev_lon_;
+};
@@ -0,0 +1,142 @@
+#include "sensor_consumer.h"
+#include "mqtt_client.h"
+#include <cstring>
+
+SensorConsumer::SensorConsumer(size_t ring_capacity, size_t max_devices)
+    : ring_capacity_(ring_capacity)
+    , devices_(max_devices)
+    , device_count_(0)
+    , last_device_(nullptr)
+    , decoded_(0)
+    , errors_(0)
+    , dropped_(0)
+{
+    index_.reserve(max_devices);
+}
+
+void SensorConsumer::attach(MqttClient& client, const std::string& topic_filter, int qos) {
+    client.setOnRawMessage([this](const char* topic, const void* payload, size_t size) {
+        ingest(topic, payload, size);
+    });
+    client.setOnConnect([&client, topic_filter, qos](int rc) {
+        if (rc == 0) {
+            client.subscribe(topic_filter, qos);
+        }
+    });
+    if (client.isConnected()) {
+        client.subscribe(topic_filter, qos);
+    }
+}
+
+bool SensorConsumer::ingest(const char* topic, const void* payload, size_t size) {
+    static constexpr char kPrefix[] = "sensor/";
+    static constexpr size_t kPrefixLen = sizeof(kPrefix) - 1;
+    if (!topic || std::strncmp(topic, kPrefix, kPrefixLen) != 0) {
+        return false;
+    }
+    const char* channel = topic + kPrefixLen;
+
+    DecodedSample sample;
+    DeviceStreams* dev = nullptr;
+    bool ok = false;
+
+    if (std::strcmp(channel, "all") == 0) {
+        ok = SensorWireDecoder::decodeSensorData(payload, size, sample);
+        if (ok && (dev = deviceFor(sample.device_id))) {
+            dev->all.append(sample.timestamp, sample.sequence,
+                            {sample.cpu_temperature, sample.compass_heading, sample.latitude,
+                             sample.longitude, sample.altitude, sample.accuracy});
+        }
+    } else if (std::strcmp(channel, "temperature") == 0) {
+        ok = SensorWireDecoder::decodeTemperature(payload, size, sample);
+        if (ok && (dev = deviceFor(sample.device_id))) {
+            dev->temperature.append(sample.timestamp, sample.sequence, {sample.cpu_temperature});
+        }
+    } else if (std::strcmp(channel, "compass") == 0) {
+        ok = SensorWireDecoder::decodeCompass(payload, size, sample);
+        if (ok && (dev = deviceFor(sample.device_id))) {
+            dev->compass.append(sample.timestamp, sample.sequence, {sample.compass_heading});
+        }
+    } else if (std::strcmp(channel, "gps") == 0) {
+        ok = SensorWireDecoder::decodeGpsPosition(payload, size, sample);
+        if (ok && (dev = deviceFor(sample.device_id))) {
+            dev->gps.append(sample.timestamp, sample.sequence,
+                            {sample.latitude, sample.longitude, sample.altitude, sample.accuracy});
+        }
+    } else if (std::strcmp(channel, "status") == 0) {
+        DecodedStatus status;
+        ok = SensorWireDecoder::decodeStatus(payload, size, status);
+        if (ok && (dev = deviceFor(status.device_id))) {
+            dev->status_timestamp.store(status.timestamp, std::memory_order_relaxed);
+            dev->status.store(status.status, std::memory_order_release);
+        }
+    } else {
+        return false;  // topic not produced by the simulator
+    }
+
+    if (!ok) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    decoded_.fetch_add(1, std::memory_order_relaxed);
+    return dev != nullptr;
+}
+
+DeviceStreams* SensorConsumer::deviceFor(std::string_view device_id) {
+    // Telemetry arrives in bursts per device, so check the previous hit first
+    if (last_device_ && last_device_->device_id == device_id) {
+        return last_device_;
+    }
+
+    auto it = index_.find(device_id);
+    if (it != index_.end()) {
+        last_device_ = it->second;
+        return last_device_;
+    }
+
+    size_t count = device_count_.load(std::memory_order_relaxed);
+    if (count >= devices_.size()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    devices_[count] = std::make_unique<DeviceStreams>(std::string(device_id), ring_capacity_);
+    DeviceStreams* dev = devices_[count].get();
+    index_.emplace(std::string_view(dev->device_id), dev);
+    device_count_.store(count + 1, std::memory_order_release);
+    last_device_ = dev;
+    return dev;
+}
+
+size_t SensorConsumer::deviceCount() const {
+    return device_count_.load(std::memory_order_acquire);
+}
+
+const DeviceStreams* SensorConsumer::device(size_t index) const {
+    if (index >= deviceCount()) {
+        return nullptr;
+    }
+    return devices_[index].get();
+}
+
+const DeviceStreams* SensorConsumer::findDevice(std::string_view device_id) const {
+    size_t count = deviceCount();
+    for (size_t i = 0; i < count; i++) {
+        if (devices_[i]->device_id == device_id) {
+            return devices_[i].get();
+        }
+    }
+    return nullptr;
+}
+
+uint64_t SensorConsumer::messagesDecoded() const {
+    return decoded_.load(std::memory_order_relaxed);
+}
+
+uint64_t SensorConsumer::decodeErrors() const {
+    return errors_.load(std::memory_order_relaxed);
+}
+
+uint64_t SensorConsumer::devicesDropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
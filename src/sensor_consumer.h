@@ -0,0 +1,85 @@
+#pragma once
+
+#include "columnar_ring.h"
+#include "sensor_wire_decoder.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class MqttClient;
+
+// Decoded streams for one device. Each topic gets its own columnar ring.
+struct DeviceStreams {
+    // Column indices
+    enum AllColumn { kCpuTemperature, kCompassHeading, kLatitude, kLongitude, kAltitude, kAccuracy };
+    enum GpsColumn { kGpsLatitude, kGpsLongitude, kGpsAltitude, kGpsAccuracy };
+
+    DeviceStreams(const std::string& id, size_t capacity)
+        : device_id(id)
+        , all(capacity)
+        , temperature(capacity)
+        , compass(capacity)
+        , gps(capacity)
+        , status(0)
+        , status_timestamp(0)
+    {
+    }
+
+    const std::string device_id;
+    ColumnarRing<6> all;          // sensor/all
+    ColumnarRing<1> temperature;  // sensor/temperature
+    ColumnarRing<1> compass;      // sensor/compass
+    ColumnarRing<4> gps;          // sensor/gps
+    std::atomic<int> status;      // last sensor/status value
+    std::atomic<int64_t> status_timestamp;
+};
+
+// High-throughput consumer for the sensor/# topics.
+//
+// Payloads are decoded with SensorWireDecoder directly from the MQTT buffer
+// and appended to per-device columnar rings. Decoding runs on the MQTT loop
+// thread (the single writer); readers scan rings from any thread without
+// locks. The only allocation on the ingest path is creating a device the
+// first time its id is seen.
+class SensorConsumer {
+public:
+    explicit SensorConsumer(size_t ring_capacity = 1024, size_t max_devices = 4096);
+    ~SensorConsumer() = default;
+
+    // Route the client's messages into this consumer and subscribe to
+    // topic_filter on every (re)connect. Takes over the client's message
+    // and connect callbacks.
+    void attach(MqttClient& client, const std::string& topic_filter = "sensor/#", int qos = 0);
+
+    // Decode one message. Called by attach(); exposed for replay and tests.
+    bool ingest(const char* topic, const void* payload, size_t size);
+
+    // Reader side
+    size_t deviceCount() const;
+    const DeviceStreams* device(size_t index) const;
+    const DeviceStreams* findDevice(std::string_view device_id) const;
+
+    uint64_t messagesDecoded() const;
+    uint64_t decodeErrors() const;
+    uint64_t devicesDropped() const;
+
+private:
+    DeviceStreams* deviceFor(std::string_view device_id);
+
+    const size_t ring_capacity_;
+
+    // Published device table: slots [0, device_count_) are immutable once set
+    std::vector<std::unique_ptr<DeviceStreams>> devices_;
+    std::atomic<size_t> device_count_;
+
+    // Writer-only index; keys view the owned DeviceStreams::device_id
+    std::unordered_map<std::string_view, DeviceStreams*> index_;
+    DeviceStreams* last_device_;
+
+    std::atomic<uint64_t> decoded_;
+    std::atomic<uint64_t> errors_;
+    std::atomic<uint64_t> dropped_;
+};
@@ -0,0 +1,139 @@
+#include "sensor_fusion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kMetersPerDegree = 111320.0;
+
+double secondsBetween(std::chrono::system_clock::time_point a, std::chrono::system_clock::time_point b) {
+    double dt = std::chrono::duration<double>(b - a).count();
+    return std::max(dt, 1e-3);  // guard against equal or reversed timestamps
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// LocalFrame
+// ---------------------------------------------------------------------------
+void LocalFrame::setOrigin(double lat, double lon) {
+    origin_lat = lat;
+    origin_lon = lon;
+    meters_per_deg_lat = kMetersPerDegree;
+    meters_per_deg_lon = kMetersPerDegree * std::cos(lat * M_PI / 180.0);
+}
+
+void LocalFrame::toLocal(double lat, double lon, double& east, double& north) const {
+    east = (lon - origin_lon) * meters_per_deg_lon;
+    north = (lat - origin_lat) * meters_per_deg_lat;
+}
+
+void LocalFrame::toGeodetic(double east, double north, double& lat, double& lon) const {
+    lat = origin_lat + north / meters_per_deg_lat;
+    lon = origin_lon + east / meters_per_deg_lon;
+}
+
+// ---------------------------------------------------------------------------
+// SensorFusion
+// ---------------------------------------------------------------------------
+SensorFusion::SensorFusion(const FusionConfig& config)
+    : config_(config)
+    , initialized_(false)
+{
+}
+
+void SensorFusion::reset() {
+    initialized_ = false;
+}
+
+void SensorFusion::apply(SensorData& data) {
+    double sigma = std::max(data.gps_accuracy, config_.min_position_sigma);
+
+    if (!initialized_) {
+        frame_.setOrigin(data.gps_latitude, data.gps_longitude);
+        filter_.init(0.0, 0.0, sigma, data.compass_heading);
+        last_timestamp_ = data.timestamp;
+        initialized_ = true;
+    } else {
+        double east, north;
+        frame_.toLocal(data.gps_latitude, data.gps_longitude, east, north);
+        double dt = secondsBetween(last_timestamp_, data.timestamp);
+        filter_.step(dt, east, north, sigma, data.compass_heading, config_);
+        last_timestamp_ = data.timestamp;
+    }
+
+    frame_.toGeodetic(filter_.east(), filter_.north(), data.gps_latitude, data.gps_longitude);
+    data.compass_heading = filter_.heading();
+    data.gps_accuracy = filter_.accuracy();
+}
+
+// ---------------------------------------------------------------------------
+// SensorFusionBatch
+// ---------------------------------------------------------------------------
+SensorFusionBatch::SensorFusionBatch(size_t num_devices, const FusionConfig& config)
+    : config_(config)
+    , num_devices_(num_devices)
+    , groups_((num_devices + kLanes - 1) / kLanes)
+    , frames_(num_devices)
+    , last_timestamps_(num_devices)
+    , initialized_(num_devices, false)
+{
+}
+
+void SensorFusionBatch::apply(SensorData* samples, size_t count) {
+    count = std::min(count, num_devices_);
+    const uint32_t all_lanes = (1u << kLanes) - 1;
+
+    for (size_t g = 0; g < groups_.size() && g * kLanes < count; g++) {
+        size_t base = g * kLanes;
+        size_t lanes = std::min(kLanes, count - base);
+        LaneT dt(1.0), east(0.0), north(0.0), sigma(1.0), heading(0.0);
+        uint32_t fresh = 0;
+        uint32_t stepped = 0;
+
+        // Gather: convert each lane's sample to its local frame
+        for (size_t lane = 0; lane < lanes; lane++) {
+            size_t d = base + lane;
+            SensorData& s = samples[d];
+            if (!initialized_[d]) {
+                frames_[d].setOrigin(s.gps_latitude, s.gps_longitude);
+                last_timestamps_[d] = s.timestamp;
+                initialized_[d] = true;
+                fresh |= 1u << lane;
+            } else {
+                stepped |= 1u << lane;
+            }
+            frames_[d].toLocal(s.gps_latitude, s.gps_longitude, east[lane], north[lane]);
+            dt[lane] = secondsBetween(last_timestamps_[d], s.timestamp);
+            sigma[lane] = std::max(s.gps_accuracy, config_.min_position_sigma);
+            heading[lane] = s.compass_heading;
+            last_timestamps_[d] = s.timestamp;
+        }
+
+        // One pass for all lanes of the group. Lanes without a new sample
+        // are restored afterwards; new devices start from their first fix.
+        GpsCompassFilter<LaneT>& filter = groups_[g];
+        if (stepped == all_lanes) {
+            filter.step(dt, east, north, sigma, heading, config_);
+        } else if (stepped != 0) {
+            GpsCompassFilter<LaneT> before = filter;
+            filter.step(dt, east, north, sigma, heading, config_);
+            filter.mergeLanes(before, all_lanes & ~stepped);
+        }
+        if (fresh != 0) {
+            GpsCompassFilter<LaneT> start;
+            start.init(east, north, sigma, heading);
+            filter.mergeLanes(start, fresh);
+        }
+
+        // Scatter the estimates back into the samples
+        LaneT fe = filter.east(), fn = filter.north(), fh = filter.heading(), acc = filter.accuracy();
+        for (size_t lane = 0; lane < lanes; lane++) {
+            size_t d = base + lane;
+            SensorData& s = samples[d];
+            frames_[d].toGeodetic(fe[lane], fn[lane], s.gps_latitude, s.gps_longitude);
+            s.compass_heading = fh[lane];
+            s.gps_accuracy = acc[lane];
+        }
+    }
+}
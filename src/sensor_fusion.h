@@ -0,0 +1,178 @@
+#pragma once
+
+#include "sensor_simulator.h"
+#include "kalman_filter.h"
+#include <cstdint>
+#include <vector>
+
+struct FusionConfig {
+    double accel_noise = 0.5;          // m/s^2, white-noise acceleration (position model)
+    double heading_accel_noise = 2.0;  // deg/s^2, white-noise angular acceleration
+    double heading_sigma = 5.0;        // degrees, compass measurement noise
+    double min_position_sigma = 0.5;   // meters, floor applied to the reported GPS accuracy
+};
+
+// Constant-velocity filters for one device, or for W devices when T is Lane<W>:
+//   position: [east, north, v_east, v_north] in meters, measured [east, north]
+//   heading:  [heading, heading_rate] in degrees, measured [heading]
+// Position and heading are independent, so the joint covariance is block
+// diagonal and the two blocks are filtered separately.
+template <typename T>
+class GpsCompassFilter {
+public:
+    void init(const T& east, const T& north, const T& position_sigma, const T& heading) {
+        pos_.x = Matrix<T, 4, 1>::zero();
+        pos_.x.m[0][0] = east;
+        pos_.x.m[1][0] = north;
+        pos_.P = Matrix<T, 4, 4>::zero();
+        T pos_var = position_sigma * position_sigma;
+        pos_.P.m[0][0] = pos_var;
+        pos_.P.m[1][1] = pos_var;
+        pos_.P.m[2][2] = T(25.0);  // unknown velocity: +-5 m/s
+        pos_.P.m[3][3] = T(25.0);
+
+        head_.x.m[0][0] = heading;
+        head_.x.m[1][0] = T(0.0);
+        head_.P = Matrix<T, 2, 2>::zero();
+        head_.P.m[0][0] = T(100.0);
+        head_.P.m[1][1] = T(100.0);
+    }
+
+    // One predict/update cycle. dt in seconds.
+    void step(const T& dt, const T& east, const T& north, const T& position_sigma,
+              const T& heading, const FusionConfig& config) {
+        using std::floor;
+
+        // Position: predict
+        Matrix<T, 4, 4> F = Matrix<T, 4, 4>::identity();
+        F.m[0][2] = dt;
+        F.m[1][3] = dt;
+        T dt2 = dt * dt;
+        T q = T(config.accel_noise * config.accel_noise);
+        T q11 = q * dt2 * dt / T(3.0);
+        T q12 = q * dt2 / T(2.0);
+        T q22 = q * dt;
+        Matrix<T, 4, 4> Q = Matrix<T, 4, 4>::zero();
+        Q.m[0][0] = q11; Q.m[0][2] = q12; Q.m[2][0] = q12; Q.m[2][2] = q22;
+        Q.m[1][1] = q11; Q.m[1][3] = q12; Q.m[3][1] = q12; Q.m[3][3] = q22;
+        pos_.predict(F, Q);
+
+        // Position: update
+        Matrix<T, 2, 4> H = Matrix<T, 2, 4>::zero();
+        H.m[0][0] = T(1.0);
+        H.m[1][1] = T(1.0);
+        Matrix<T, 2, 2> R = Matrix<T, 2, 2>::zero();
+        R.m[0][0] = position_sigma * position_sigma;
+        R.m[1][1] = position_sigma * position_sigma;
+        Matrix<T, 2, 1> y;
+        y.m[0][0] = east - pos_.x.m[0][0];
+        y.m[1][0] = north - pos_.x.m[1][0];
+        pos_.update(y, H, R);
+
+        // Heading: predict
+        Matrix<T, 2, 2> Fh = Matrix<T, 2, 2>::identity();
+        Fh.m[0][1] = dt;
+        T qh = T(config.heading_accel_noise * config.heading_accel_noise);
+        Matrix<T, 2, 2> Qh;
+        Qh.m[0][0] = qh * dt2 * dt / T(3.0);
+        Qh.m[0][1] = qh * dt2 / T(2.0);
+        Qh.m[1][0] = Qh.m[0][1];
+        Qh.m[1][1] = qh * dt;
+        head_.predict(Fh, Qh);
+
+        // Heading: update with the innovation wrapped to [-180, 180)
+        Matrix<T, 1, 2> Hh;
+        Hh.m[0][0] = T(1.0);
+        Hh.m[0][1] = T(0.0);
+        Matrix<T, 1, 1> Rh;
+        Rh.m[0][0] = T(config.heading_sigma * config.heading_sigma);
+        Matrix<T, 1, 1> yh;
+        T diff = heading - head_.x.m[0][0] + T(180.0);
+        yh.m[0][0] = diff - T(360.0) * floor(diff / T(360.0)) - T(180.0);
+        head_.update(yh, Hh, Rh);
+
+        // Keep the heading state in [0, 360)
+        T h = head_.x.m[0][0];
+        head_.x.m[0][0] = h - T(360.0) * floor(h / T(360.0));
+    }
+
+    // Batched filters only: lanes set in mask take their state from other
+    void mergeLanes(const GpsCompassFilter& other, uint32_t mask) {
+        selectLanes(pos_.x, other.pos_.x, mask);
+        selectLanes(pos_.P, other.pos_.P, mask);
+        selectLanes(head_.x, other.head_.x, mask);
+        selectLanes(head_.P, other.head_.P, mask);
+    }
+
+    T east() const { return pos_.x.m[0][0]; }
+    T north() const { return pos_.x.m[1][0]; }
+    T velocityEast() const { return pos_.x.m[2][0]; }
+    T velocityNorth() const { return pos_.x.m[3][0]; }
+    T heading() const { return head_.x.m[0][0]; }
+
+    // Horizontal RMS position error in meters, sqrt(var_east + var_north)
+    T accuracy() const {
+        using std::sqrt;
+        return sqrt(pos_.P.m[0][0] + pos_.P.m[1][1]);
+    }
+
+private:
+    KalmanFilter<T, 4, 2> pos_;
+    KalmanFilter<T, 2, 1> head_;
+};
+
+// Local tangent plane around a fixed origin for meter-space filtering
+struct LocalFrame {
+    double origin_lat = 0.0;
+    double origin_lon = 0.0;
+    double meters_per_deg_lat = 0.0;
+    double meters_per_deg_lon = 0.0;
+
+    void setOrigin(double lat, double lon);
+    void toLocal(double lat, double lon, double& east, double& north) const;
+    void toGeodetic(double east, double north, double& lat, double& lon) const;
+};
+
+// On-device fusion for one device. apply() replaces the noisy GPS position
+// and compass heading in the sample with the filtered estimate and sets
+// gps_accuracy from the filter covariance.
+class SensorFusion {
+public:
+    explicit SensorFusion(const FusionConfig& config = FusionConfig());
+
+    void apply(SensorData& data);
+    void reset();
+
+private:
+    FusionConfig config_;
+    GpsCompassFilter<double> filter_;
+    LocalFrame frame_;
+    bool initialized_;
+    std::chrono::system_clock::time_point last_timestamp_;
+};
+
+// Fusion for many devices at once: devices are packed kLanes to a filter
+// and each group steps in lockstep. Only faster than one SensorFusion per
+// device when the build targets AVX-512; see "GPS/Compass Fusion" in README.
+class SensorFusionBatch {
+public:
+    static constexpr size_t kLanes = 8;  // at most 32: lane masks are uint32_t
+    using LaneT = Lane<kLanes>;
+
+    SensorFusionBatch(size_t num_devices, const FusionConfig& config = FusionConfig());
+
+    // samples[i] is the new sample of device i for i < count; those devices
+    // step together and the rest keep their state. A device's first sample
+    // initializes its filter lanes.
+    void apply(SensorData* samples, size_t count);
+
+    size_t size() const { return num_devices_; }
+
+private:
+    FusionConfig config_;
+    size_t num_devices_;
+    std::vector<GpsCompassFilter<LaneT>> groups_;
+    std::vector<LocalFrame> frames_;
+    std::vector<std::chrono::system_clock::time_point> last_timestamps_;
+    std::vector<bool> initialized_;
+};
@@ -0,0 +1,335 @@
+// sensor_probe: subscribes to the sensor topics and measures loss, gaps,
+// reordering and end-to-end latency using the sequence number and monotonic
+// send timestamp carried by every telemetry message.
+//
+// Latency is only meaningful when the probe runs on the same host as the
+// simulator, since both sides read CLOCK_MONOTONIC.
+//
+// With --shm the probe polls the shared-memory ring instead, which gives the
+// latency of the broker-bypass path for comparison with MQTT loopback.
+//
+// With --ping the probe also sends 'ping' ActionRequests and reports the
+// request-to-ack round trip as the "ack/ping" row.
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <map>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <signal.h>
+#include <unistd.h>
+#include "mqtt_client.h"
+#include "protobuf_converter.h"
+#include "shm_ring.h"
+#include "sensor.pb.h"
+#include "actions.pb.h"
+
+volatile bool running = true;
+
+void signalHandler(int signum) {
+    running = false;
+}
+
+// Per-topic sequence and latency tracking
+struct TopicStats {
+    // Sequences counted as lost are remembered for this many positions below
+    // the highest seen, so a late arrival can be told apart from a duplicate
+    static constexpr uint64_t kMissingWindow = 4096;
+
+    uint64_t received = 0;
+    uint64_t lost = 0;        // sequence numbers skipped and not filled in later
+    uint64_t gaps = 0;        // number of forward jumps in the sequence
+    uint64_t reordered = 0;   // late arrivals older than the highest seen sequence
+    uint64_t duplicates = 0;  // repeats of an already received sequence
+    bool started = false;
+    uint64_t first_seq = 0;
+    uint64_t highest_seq = 0;
+    std::vector<uint64_t> missing = std::vector<uint64_t>(kMissingWindow / 64);  // bit per seq % kMissingWindow
+    std::vector<int64_t> latency_ns;
+
+    bool isMissing(uint64_t seq) const {
+        uint64_t slot = seq % kMissingWindow;
+        return (missing[slot / 64] >> (slot % 64)) & 1;
+    }
+
+    void setMissing(uint64_t seq, bool value) {
+        uint64_t slot = seq % kMissingWindow;
+        uint64_t bit = uint64_t(1) << (slot % 64);
+        missing[slot / 64] = value ? (missing[slot / 64] | bit) : (missing[slot / 64] & ~bit);
+    }
+
+    void record(uint64_t seq, int64_t send_ns, int64_t recv_ns) {
+        received++;
+        if (!started) {
+            started = true;
+            first_seq = highest_seq = seq;
+        } else if (seq > highest_seq) {
+            if (seq > highest_seq + 1) {
+                gaps++;
+                lost += seq - highest_seq - 1;
+            }
+            // Slots entering the window are reused: mark the skipped ones,
+            // clear the received one
+            uint64_t from = std::max(highest_seq + 1, seq >= kMissingWindow ? seq - kMissingWindow + 1 : 0);
+            for (uint64_t s = from; s <= seq; s++) {
+                setMissing(s, s != seq);
+            }
+            highest_seq = seq;
+        } else if (seq >= first_seq && highest_seq - seq < kMissingWindow && isMissing(seq)) {
+            // A late arrival fills a hole that was counted as lost
+            reordered++;
+            lost--;
+            setMissing(seq, false);
+        } else if (seq < first_seq || highest_seq - seq >= kMissingWindow) {
+            reordered++;  // before the first sample or too old to tell
+        } else {
+            duplicates++;
+        }
+        if (send_ns > 0) {
+            latency_ns.push_back(recv_ns - send_ns);
+        }
+    }
+};
+
+static double percentileUs(std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)] / 1000.0;
+}
+
+// Subscribes through the broker until keepRunning() returns false
+template <typename KeepRunning>
+bool probeMqtt(const std::string& broker, int port, const std::string& topic_filter, int qos, double ping_hz,
+               std::map<std::string, TopicStats>& stats, std::mutex& stats_mutex, KeepRunning keepRunning) {
+    MqttClient mqtt_client;
+    std::string client_id = "sensor_probe_" + std::to_string(getpid());
+    std::string ack_topic = "probe/ack/" + client_id;
+    mqtt_client.setClientId(client_id);
+
+    mqtt_client.setOnMessage([&stats, &stats_mutex, ack_topic](const std::string& topic, const std::string& payload) {
+        int64_t recv_ns = ProtobufConverter::monotonicNowNs();
+        uint64_t seq = 0;
+        int64_t send_ns = 0;
+
+        if (topic == ack_topic) {
+            // The ping handler echoes "<seq> <send_ns>"
+            actions::ActionAck ack;
+            if (!ack.ParseFromString(payload) || !ack.success()) return;
+            if (std::sscanf(ack.ack().c_str(), "%" SCNu64 " %" SCNd64, &seq, &send_ns) != 2) return;
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            stats["ack/ping"].record(seq, send_ns, recv_ns);
+            return;
+        } else if (topic == "sensor/all") {
+            sensor::SensorData msg;
+            if (!msg.ParseFromString(payload)) return;
+            seq = msg.sequence();
+            send_ns = msg.send_time_ns();
+        } else if (topic == "sensor/temperature") {
+            sensor::TemperatureData msg;
+            if (!msg.ParseFromString(payload)) return;
+            seq = msg.sequence();
+            send_ns = msg.send_time_ns();
+        } else if (topic == "sensor/compass") {
+            sensor::CompassData msg;
+            if (!msg.ParseFromString(payload)) return;
+            seq = msg.sequence();
+            send_ns = msg.send_time_ns();
+        } else if (topic == "sensor/gps") {
+            sensor::GpsPositionData msg;
+            if (!msg.ParseFromString(payload)) return;
+            seq = msg.sequence();
+            send_ns = msg.send_time_ns();
+        } else {
+            return;  // status and other topics carry no sequence numbers
+        }
+
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        stats[topic].record(seq, send_ns, recv_ns);
+    });
+
+    mqtt_client.setOnConnect([&mqtt_client, topic_filter, qos, ping_hz, ack_topic](int rc) {
+        if (rc == 0) {
+            mqtt_client.subscribe(topic_filter, qos);
+            if (ping_hz > 0.0) {
+                mqtt_client.subscribe(ack_topic, 1);
+            }
+        }
+    });
+
+    if (!mqtt_client.connect(broker, port)) {
+        std::cerr << "Failed to connect to MQTT broker. Exiting." << std::endl;
+        return false;
+    }
+    mqtt_client.loopStart();
+
+    auto ping_period = ping_hz > 0.0
+        ? std::chrono::microseconds(static_cast<int64_t>(1e6 / ping_hz))
+        : std::chrono::microseconds(100000);
+    auto next_ping = std::chrono::steady_clock::now() + std::chrono::seconds(1);  // let subscriptions settle
+    uint64_t ping_seq = 0;
+    while (keepRunning()) {
+        if (ping_hz > 0.0 && mqtt_client.isConnected() && std::chrono::steady_clock::now() >= next_ping) {
+            actions::ActionRequest req;
+            req.set_topic("action/ping");
+            req.set_payload(std::to_string(ping_seq++) + " " + std::to_string(ProtobufConverter::monotonicNowNs()));
+            req.set_ack_topic(ack_topic);
+            std::string request;
+            req.SerializeToString(&request);
+            mqtt_client.publish("action/ping", request, 1);
+            next_ping += ping_period;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::microseconds>(ping_period, std::chrono::milliseconds(100)));
+    }
+
+    mqtt_client.disconnect();
+    mqtt_client.loopStop();
+    return true;
+}
+
+// Polls the shared-memory ring until keepRunning() returns false
+template <typename KeepRunning>
+bool probeShm(const std::string& name, TopicStats& stats, KeepRunning keepRunning) {
+    ShmRingReader reader;
+    if (!reader.open(name)) {
+        return false;
+    }
+
+    // Busy-poll with a yield, starting from the newest sample
+    uint64_t cursor = reader.writeIndex();
+    ShmSample batch[64];
+    while (keepRunning()) {
+        size_t n = reader.readSince(cursor, batch, 64);
+        int64_t recv_ns = ProtobufConverter::monotonicNowNs();
+        for (size_t i = 0; i < n; i++) {
+            stats.record(batch[i].sequence, batch[i].send_time_ns, recv_ns);
+        }
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+    }
+    return true;
+}
+
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS]\n"
+              << "Options:\n"
+              << "  -b, --broker HOST[:PORT]    MQTT broker address (default: localhost:1883)\n"
+              << "  -t, --topic FILTER          Subscription filter (default: sensor/#)\n"
+              << "  -D, --duration SEC          Measurement duration, 0 runs until Ctrl+C (default: 10)\n"
+              << "  -q, --qos QOS               Subscription QoS (default: 0)\n"
+              << "  -s, --shm NAME              Read the /dev/shm/NAME ring instead of subscribing\n"
+              << "  -P, --ping HZ               Also send 'ping' actions and time the acks (default: off)\n"
+              << "  -h, --help                  Show this help message\n"
+              << "\nPrints a per-topic table and a final machine-readable SUMMARY line."
+              << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string broker = "localhost";
+    int port = 1883;
+    std::string topic_filter = "sensor/#";
+    int duration_s = 10;
+    int qos = 0;
+    std::string shm_name;
+    double ping_hz = 0.0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "-b" || arg == "--broker") {
+            if (++i < argc) {
+                std::string broker_arg = argv[i];
+                size_t colon_pos = broker_arg.find(':');
+                if (colon_pos != std::string::npos) {
+                    broker = broker_arg.substr(0, colon_pos);
+                    port = std::stoi(broker_arg.substr(colon_pos + 1));
+                } else {
+                    broker = broker_arg;
+                }
+            }
+        } else if (arg == "-t" || arg == "--topic") {
+            if (++i < argc) topic_filter = argv[i];
+        } else if (arg == "-D" || arg == "--duration") {
+            if (++i < argc) duration_s = std::stoi(argv[i]);
+        } else if (arg == "-q" || arg == "--qos") {
+            if (++i < argc) qos = std::stoi(argv[i]);
+        } else if (arg == "-s" || arg == "--shm") {
+            if (++i < argc) shm_name = argv[i];
+        } else if (arg == "-P" || arg == "--ping") {
+            if (++i < argc) ping_hz = std::stod(argv[i]);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    std::mutex stats_mutex;
+    std::map<std::string, TopicStats> stats;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(duration_s);
+    auto keepRunning = [deadline, duration_s]() {
+        return running && (duration_s <= 0 || std::chrono::steady_clock::now() < deadline);
+    };
+
+    bool ok = shm_name.empty()
+        ? probeMqtt(broker, port, topic_filter, qos, ping_hz, stats, stats_mutex, keepRunning)
+        : probeShm(shm_name, stats["shm/" + shm_name], keepRunning);
+    if (!ok) {
+        return 1;
+    }
+
+    // Report
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    uint64_t total_received = 0;
+    uint64_t total_lost = 0;
+    std::vector<int64_t> all_latencies;
+
+    std::cout << std::left << std::setw(22) << "Topic" << std::right
+              << std::setw(10) << "Received" << std::setw(9) << "Lost" << std::setw(9) << "Loss%"
+              << std::setw(7) << "Gaps" << std::setw(9) << "Reorder" << std::setw(6) << "Dup"
+              << std::setw(10) << "p50(us)" << std::setw(10) << "p99(us)" << std::setw(11) << "p99.9(us)"
+              << std::setw(10) << "max(us)" << std::endl;
+
+    for (auto& [topic, s] : stats) {
+        std::sort(s.latency_ns.begin(), s.latency_ns.end());
+        double loss_pct = (s.received + s.lost) ? 100.0 * s.lost / (s.received + s.lost) : 0.0;
+        std::cout << std::left << std::setw(22) << topic << std::right
+                  << std::setw(10) << s.received << std::setw(9) << s.lost
+                  << std::setw(9) << std::fixed << std::setprecision(3) << loss_pct
+                  << std::setw(7) << s.gaps << std::setw(9) << s.reordered << std::setw(6) << s.duplicates
+                  << std::setprecision(1)
+                  << std::setw(10) << percentileUs(s.latency_ns, 0.50)
+                  << std::setw(10) << percentileUs(s.latency_ns, 0.99)
+                  << std::setw(11) << percentileUs(s.latency_ns, 0.999)
+                  << std::setw(10) << percentileUs(s.latency_ns, 1.0) << std::endl;
+
+        total_received += s.received;
+        total_lost += s.lost;
+        all_latencies.insert(all_latencies.end(), s.latency_ns.begin(), s.latency_ns.end());
+    }
+
+    std::sort(all_latencies.begin(), all_latencies.end());
+    double total_loss_pct = (total_received + total_lost) ? 100.0 * total_lost / (total_received + total_lost) : 0.0;
+    std::cout << std::fixed << std::setprecision(3)
+              << "SUMMARY received=" << total_received
+              << " lost=" << total_lost
+              << " loss_pct=" << total_loss_pct
+              << " p50_us=" << percentileUs(all_latencies, 0.50)
+              << " p99_us=" << percentileUs(all_latencies, 0.99)
+              << " p999_us=" << percentileUs(all_latencies, 0.999)
+              << " max_us=" << percentileUs(all_latencies, 1.0) << std::endl;
+
+    return 0;
+}
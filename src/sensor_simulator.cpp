@@ -16,6 +16,7 @@ SensorSimulator::SensorSimulator()
     , current_lon_(-122.4194)
     , current_alt_(100.0)
     , last_update_(std::chrono::system_clock::now())
+    , sequence_(0)
 {
 }
 
@@ -29,7 +30,9 @@ SensorData SensorSimulator::generateSensorData() {
     data.gps_latitude = current_lat_;
     data.gps_longitude = current_lon_;
     data.gps_altitude = current_alt_;
+    data.gps_accuracy = 5.0;  // Nominal accuracy of 5 meters
     data.timestamp = std::chrono::system_clock::now();
+    data.sequence = sequence_++;
     
     return data;
 }
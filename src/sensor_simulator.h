@@ -3,6 +3,7 @@
 #include <random>
 #include <chrono>
 #include <string>
+#include <cstdint>
 
 struct SensorData {
     double cpu_temperature;  // in Celsius
@@ -10,7 +11,9 @@ struct SensorData {
     double gps_latitude;     // in decimal degrees
     double gps_longitude;    // in decimal degrees
     double gps_altitude;     // in meters
+    double gps_accuracy;     // estimated horizontal position error in meters
     std::chrono::system_clock::time_point timestamp;
+    uint64_t sequence;       // monotonically increasing per generated sample
 };
 
 class SensorSimulator {
@@ -49,6 +52,7 @@ private:
 
     // Time tracking
     std::chrono::system_clock::time_point last_update_;
+    uint64_t sequence_;
 
     // Helper methods
     double simulateCpuTemperature();
@@ -0,0 +1,217 @@
+#include "sensor_wire_decoder.h"
+#include <cstring>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "SensorWireDecoder assumes a little-endian host"
+#endif
+
+namespace {
+
+enum WireType : uint32_t {
+    kVarint = 0,
+    kFixed64 = 1,
+    kLengthDelimited = 2,
+    kFixed32 = 5,
+};
+
+// Cursor over a protobuf-encoded buffer
+class WireReader {
+public:
+    WireReader(const void* data, size_t size)
+        : p_(static_cast<const uint8_t*>(data))
+        , end_(p_ + size)
+    {
+    }
+
+    bool done() const { return p_ >= end_; }
+
+    bool readVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && p_ < end_; shift += 7) {
+            uint8_t byte = *p_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readTag(uint32_t& field, uint32_t& wire_type) {
+        uint64_t tag;
+        if (!readVarint(tag)) return false;
+        field = static_cast<uint32_t>(tag >> 3);
+        wire_type = static_cast<uint32_t>(tag & 0x7);
+        return field != 0;
+    }
+
+    bool readDouble(double& value) {
+        if (end_ - p_ < 8) return false;
+        std::memcpy(&value, p_, 8);
+        p_ += 8;
+        return true;
+    }
+
+    bool readBytes(std::string_view& value) {
+        uint64_t len;
+        if (!readVarint(len) || len > static_cast<uint64_t>(end_ - p_)) return false;
+        value = std::string_view(reinterpret_cast<const char*>(p_), len);
+        p_ += len;
+        return true;
+    }
+
+    bool skip(uint32_t wire_type) {
+        uint64_t len;
+        switch (wire_type) {
+            case kVarint:
+                return readVarint(len);
+            case kFixed64:
+                len = 8;
+                break;
+            case kLengthDelimited:
+                if (!readVarint(len)) return false;
+                break;
+            case kFixed32:
+                len = 4;
+                break;
+            default:
+                return false;
+        }
+        if (len > static_cast<uint64_t>(end_ - p_)) return false;
+        p_ += len;
+        return true;
+    }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+};
+
+// Reads a field of the expected wire type, or skips it if the type differs
+#define READ_OR_SKIP(expected, read_expr) \
+    ((wire_type == (expected)) ? (read_expr) : reader.skip(wire_type))
+
+bool decodeGpsData(std::string_view bytes, DecodedSample& out) {
+    WireReader reader(bytes.data(), bytes.size());
+    uint32_t field, wire_type;
+    while (!reader.done()) {
+        if (!reader.readTag(field, wire_type)) return false;
+        bool ok;
+        switch (field) {
+            case 1: ok = READ_OR_SKIP(kFixed64, reader.readDouble(out.latitude)); break;
+            case 2: ok = READ_OR_SKIP(kFixed64, reader.readDouble(out.longitude)); break;
+            case 3: ok = READ_OR_SKIP(kFixed64, reader.readDouble(out.altitude)); break;
+            case 4: ok = READ_OR_SKIP(kFixed64, reader.readDouble(out.accuracy)); break;
+            default: ok = reader.skip(wire_type); break;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool readInt64(WireReader& reader, int64_t& value) {
+    uint64_t raw;
+    if (!reader.readVarint(raw)) return false;
+    value = static_cast<int64_t>(raw);
+    return true;
+}
+
+// Shared layout of TemperatureData and CompassData: a double reading in
+// field 1, then timestamp, unit, sequence, send time and device id
+bool decodeSingleReading(const void* data, size_t size, DecodedSample& out, double& reading) {
+    WireReader reader(data, size);
+    uint32_t field, wire_type;
+    std::string_view unit;
+    while (!reader.done()) {
+        if (!reader.readTag(field, wire_type)) return false;
+        bool ok;
+        switch (field) {
+            case 1: ok = READ_OR_SKIP(kFixed64, reader.readDouble(reading)); break;
+            case 2: ok = READ_OR_SKIP(kVarint, readInt64(reader, out.timestamp)); break;
+            case 3: ok = READ_OR_SKIP(kLengthDelimited, reader.readBytes(unit)); break;
+            case 4: ok = READ_OR_SKIP(kVarint, reader.readVarint(out.sequence)); break;
+            case 5: ok = READ_OR_SKIP(kVarint, readInt64(reader, out.send_time_ns)); break;
+            case 6: ok = READ_OR_SKIP(kLengthDelimited, reader.readBytes(out.device_id)); break;
+            default: ok = reader.skip(wire_type); break;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool SensorWireDecoder::decodeSensorData(const void* data, size_t size, DecodedSample& out) {
+    out = DecodedSample();
+    WireReader reader(data, size);
+    uint32_t field, wire_type;
+    std::string_view bytes;
+    while (!reader.done()) {
+        if (!reader.readTag(field, wire_type)) return false;
+        bool ok;
+        switch (field) {
+            case 1: ok = READ_OR_SKIP(kFixed64, reader.readDouble(out.cpu_temperature)); break;
+            case 2: ok = READ_OR_SKIP(kFixed64, reader.readDouble(out.compass_heading)); break;
+            case 3: ok = READ_OR_SKIP(kLengthDelimited, reader.readBytes(bytes) && decodeGpsData(bytes, out)); break;
+            case 4: ok = READ_OR_SKIP(kVarint, readInt64(reader, out.timestamp)); break;
+            case 5: ok = READ_OR_SKIP(kLengthDelimited, reader.readBytes(out.device_id)); break;
+            case 7: ok = READ_OR_SKIP(kVarint, reader.readVarint(out.sequence)); break;
+            case 8: ok = READ_OR_SKIP(kVarint, readInt64(reader, out.send_time_ns)); break;
+            default: ok = reader.skip(wire_type); break;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool SensorWireDecoder::decodeTemperature(const void* data, size_t size, DecodedSample& out) {
+    out = DecodedSample();
+    return decodeSingleReading(data, size, out, out.cpu_temperature);
+}
+
+bool SensorWireDecoder::decodeCompass(const void* data, size_t size, DecodedSample& out) {
+    out = DecodedSample();
+    return decodeSingleReading(data, size, out, out.compass_heading);
+}
+
+bool SensorWireDecoder::decodeGpsPosition(const void* data, size_t size, DecodedSample& out) {
+    out = DecodedSample();
+    WireReader reader(data, size);
+    uint32_t field, wire_type;
+    std::string_view bytes;
+    while (!reader.done()) {
+        if (!reader.readTag(field, wire_type)) return false;
+        bool ok;
+        switch (field) {
+            case 1: ok = READ_OR_SKIP(kLengthDelimited, reader.readBytes(bytes) && decodeGpsData(bytes, out)); break;
+            case 2: ok = READ_OR_SKIP(kVarint, readInt64(reader, out.timestamp)); break;
+            case 4: ok = READ_OR_SKIP(kVarint, reader.readVarint(out.sequence)); break;
+            case 5: ok = READ_OR_SKIP(kVarint, readInt64(reader, out.send_time_ns)); break;
+            case 6: ok = READ_OR_SKIP(kLengthDelimited, reader.readBytes(out.device_id)); break;
+            default: ok = reader.skip(wire_type); break;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool SensorWireDecoder::decodeStatus(const void* data, size_t size, DecodedStatus& out) {
+    out = DecodedStatus();
+    WireReader reader(data, size);
+    uint32_t field, wire_type;
+    uint64_t status = 0;
+    while (!reader.done()) {
+        if (!reader.readTag(field, wire_type)) return false;
+        bool ok;
+        switch (field) {
+            case 1: ok = READ_OR_SKIP(kVarint, reader.readVarint(status)); break;
+            case 2: ok = READ_OR_SKIP(kLengthDelimited, reader.readBytes(out.device_id)); break;
+            case 3: ok = READ_OR_SKIP(kVarint, readInt64(reader, out.timestamp)); break;
+            case 4: ok = READ_OR_SKIP(kLengthDelimited, reader.readBytes(out.message)); break;
+            default: ok = reader.skip(wire_type); break;
+        }
+        if (!ok) return false;
+    }
+    out.status = static_cast<int>(status);
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+// Decoded views of the sensor protobuf messages. String fields point into the
+// payload buffer that was decoded and are only valid as long as it is.
+struct DecodedSample {
+    std::string_view device_id;
+    int64_t timestamp = 0;       // Unix milliseconds
+    uint64_t sequence = 0;
+    int64_t send_time_ns = 0;    // CLOCK_MONOTONIC nanoseconds
+    double cpu_temperature = 0.0;
+    double compass_heading = 0.0;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double altitude = 0.0;
+    double accuracy = 0.0;
+};
+
+struct DecodedStatus {
+    int status = 0;              // sensor::StatusMessage::Status value
+    std::string_view device_id;
+    int64_t timestamp = 0;
+    std::string_view message;
+};
+
+// Allocation-free protobuf wire-format decoder for the messages in
+// proto/sensor.proto. Parses in place over the payload; unknown fields are
+// skipped so newer publishers remain readable. Each decode* call resets the
+// output before filling it and returns false on malformed input.
+class SensorWireDecoder {
+public:
+    static bool decodeSensorData(const void* data, size_t size, DecodedSample& out);
+    static bool decodeTemperature(const void* data, size_t size, DecodedSample& out);
+    static bool decodeCompass(const void* data, size_t size, DecodedSample& out);
+    static bool decodeGpsPosition(const void* data, size_t size, DecodedSample& out);
+    static bool decodeStatus(const void* data, size_t size, DecodedStatus& out);
+};
@@ -0,0 +1,270 @@
+#include "shm_ring.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::string shmPath(const std::string& name) {
+    return name.empty() || name[0] == '/' ? name : "/" + name;
+}
+
+size_t mappedSize(size_t capacity) {
+    return sizeof(ShmHeader) + capacity * sizeof(ShmSlot);
+}
+
+int64_t monotonicNowNs() {
+    auto duration = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// ShmSlot
+// ---------------------------------------------------------------------------
+void ShmSlot::store(const ShmSample& sample) {
+    uint64_t raw[kWords];
+    std::memcpy(raw, &sample, sizeof(raw));
+
+    uint64_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) {
+        words[i].store(raw[i], std::memory_order_relaxed);
+    }
+    seq.store(s + 2, std::memory_order_release);
+}
+
+bool ShmSlot::load(ShmSample& sample) const {
+    uint64_t s1 = seq.load(std::memory_order_acquire);
+    if (s1 & 1) {
+        return false;
+    }
+    uint64_t raw[kWords];
+    for (size_t i = 0; i < kWords; i++) {
+        raw[i] = words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq.load(std::memory_order_relaxed) != s1) {
+        return false;
+    }
+    std::memcpy(&sample, raw, sizeof(raw));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// ShmRingWriter
+// ---------------------------------------------------------------------------
+ShmRingWriter::ShmRingWriter()
+    : header_(nullptr)
+    , history_(nullptr)
+    , mapped_size_(0)
+    , mask_(0)
+{
+}
+
+ShmRingWriter::~ShmRingWriter() {
+    close();
+}
+
+bool ShmRingWriter::open(const std::string& name, size_t capacity) {
+    close();
+
+    size_t slots = 1;
+    while (slots < capacity) slots <<= 1;
+
+    // Start from a fresh segment so readers never see a stale layout
+    name_ = shmPath(name);
+    shm_unlink(name_.c_str());
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to create shared memory " << name_ << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    size_t size = mappedSize(slots);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "Failed to size shared memory " << name_ << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << name_ << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // ftruncate zero-fills, which is a valid initial state for every atomic
+    header_ = static_cast<ShmHeader*>(mem);
+    history_ = reinterpret_cast<ShmSlot*>(static_cast<char*>(mem) + sizeof(ShmHeader));
+    mapped_size_ = size;
+    mask_ = slots - 1;
+
+    header_->version = ShmHeader::kVersion;
+    header_->capacity = static_cast<uint32_t>(slots);
+    header_->slot_size = sizeof(ShmSlot);
+    header_->write_index.store(0, std::memory_order_relaxed);
+    header_->magic.store(ShmHeader::kMagic, std::memory_order_release);
+    return true;
+}
+
+void ShmRingWriter::close() {
+    if (header_) {
+        // Readers that still have the segment mapped keep working
+        munmap(header_, mapped_size_);
+        shm_unlink(name_.c_str());
+        header_ = nullptr;
+        history_ = nullptr;
+    }
+}
+
+void ShmRingWriter::publish(const SensorData& data) {
+    if (!header_) {
+        return;
+    }
+
+    uint64_t index = header_->write_index.load(std::memory_order_relaxed);
+
+    ShmSample sample;
+    sample.index = index;
+    sample.sequence = data.sequence;
+    sample.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        data.timestamp.time_since_epoch()).count();
+    sample.cpu_temperature = data.cpu_temperature;
+    sample.compass_heading = data.compass_heading;
+    sample.latitude = data.gps_latitude;
+    sample.longitude = data.gps_longitude;
+    sample.altitude = data.gps_altitude;
+    sample.accuracy = data.gps_accuracy;
+    sample.send_time_ns = monotonicNowNs();
+
+    history_[index & mask_].store(sample);
+    header_->latest.store(sample);
+    header_->write_index.store(index + 1, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------
+// ShmRingReader
+// ---------------------------------------------------------------------------
+ShmRingReader::ShmRingReader()
+    : header_(nullptr)
+    , history_(nullptr)
+    , mapped_size_(0)
+    , mask_(0)
+{
+}
+
+ShmRingReader::~ShmRingReader() {
+    close();
+}
+
+bool ShmRingReader::open(const std::string& name) {
+    close();
+
+    std::string path = shmPath(name);
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to open shared memory " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmHeader)) {
+        std::cerr << "Shared memory " << path << " is not initialized" << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void* mem = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    const ShmHeader* header = static_cast<const ShmHeader*>(mem);
+    if (header->magic.load(std::memory_order_acquire) != ShmHeader::kMagic ||
+        header->version != ShmHeader::kVersion ||
+        header->slot_size != sizeof(ShmSlot) ||
+        mappedSize(header->capacity) > static_cast<size_t>(st.st_size)) {
+        std::cerr << "Shared memory " << path << " has an incompatible layout" << std::endl;
+        munmap(mem, st.st_size);
+        return false;
+    }
+
+    header_ = header;
+    history_ = reinterpret_cast<const ShmSlot*>(static_cast<const char*>(mem) + sizeof(ShmHeader));
+    mapped_size_ = st.st_size;
+    mask_ = header->capacity - 1;
+    return true;
+}
+
+void ShmRingReader::close() {
+    if (header_) {
+        munmap(const_cast<ShmHeader*>(header_), mapped_size_);
+        header_ = nullptr;
+        history_ = nullptr;
+    }
+}
+
+bool ShmRingReader::readLatest(ShmSample& out) const {
+    if (!header_ || header_->write_index.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    while (!header_->latest.load(out)) {
+        // The producer is mid-write; the window is a few stores long
+    }
+    return true;
+}
+
+size_t ShmRingReader::readSince(uint64_t& cursor, ShmSample* out, size_t max_count, uint64_t* skipped) const {
+    if (!header_) {
+        return 0;
+    }
+
+    uint64_t head = header_->write_index.load(std::memory_order_acquire);
+    uint64_t capacity = mask_ + 1;
+    uint64_t lost = 0;
+    if (head > capacity && cursor < head - capacity) {
+        lost = head - capacity - cursor;
+        cursor = head - capacity;
+    }
+
+    size_t count = 0;
+    while (cursor < head && count < max_count) {
+        ShmSample& sample = out[count];
+        if (history_[cursor & mask_].load(sample) && sample.index == cursor) {
+            count++;
+            cursor++;
+            continue;
+        }
+        // Overwritten (or being overwritten) by a lap of the producer: jump
+        // to the oldest slot that is still safe
+        uint64_t now = header_->write_index.load(std::memory_order_acquire);
+        uint64_t oldest = now > capacity ? now - capacity + 1 : 0;
+        if (cursor < oldest) {
+            lost += oldest - cursor;
+            cursor = oldest;
+        }
+    }
+
+    if (skipped) {
+        *skipped += lost;
+    }
+    return count;
+}
+
+uint64_t ShmRingReader::writeIndex() const {
+    return header_ ? header_->write_index.load(std::memory_order_acquire) : 0;
+}
+
+size_t ShmRingReader::capacity() const {
+    return header_ ? header_->capacity : 0;
+}
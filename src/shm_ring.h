@@ -0,0 +1,106 @@
+#pragma once
+
+#include "sensor_simulator.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Shared-memory transport for co-located consumers.
+//
+// The producer maps /dev/shm/<name> and writes fixed-layout samples into a
+// latest-value slot and a history ring. Every slot is protected by a seqlock,
+// so there is a single writer and any number of readers, nobody ever blocks,
+// and readers make no syscalls after the initial mapping.
+
+// Fixed-layout sample as stored in shared memory
+struct ShmSample {
+    uint64_t index;          // position in the history ring (write order)
+    uint64_t sequence;       // SensorData::sequence
+    int64_t timestamp_ms;    // Unix milliseconds
+    int64_t send_time_ns;    // CLOCK_MONOTONIC nanoseconds at write
+    double cpu_temperature;
+    double compass_heading;
+    double latitude;
+    double longitude;
+    double altitude;
+    double accuracy;
+};
+
+static_assert(sizeof(ShmSample) % sizeof(uint64_t) == 0, "ShmSample must be a whole number of words");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+// One seqlock-protected sample. The payload is stored as relaxed atomic words
+// so concurrent reads of a slot being rewritten are well-defined; the
+// sequence check then discards the torn copy.
+struct alignas(64) ShmSlot {
+    static constexpr size_t kWords = sizeof(ShmSample) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> seq;   // odd while a write is in progress
+    std::atomic<uint64_t> words[kWords];
+
+    void store(const ShmSample& sample);
+    bool load(ShmSample& sample) const;  // false if a write raced the copy
+};
+
+struct ShmHeader {
+    static constexpr uint32_t kMagic = 0x53484D52;  // "SHMR"
+    static constexpr uint32_t kVersion = 1;
+
+    std::atomic<uint32_t> magic;    // written last by the producer
+    uint32_t version;
+    uint32_t capacity;              // history slots, power of two
+    uint32_t slot_size;
+    alignas(64) std::atomic<uint64_t> write_index;  // samples written so far
+    ShmSlot latest;
+    // ShmSlot history[capacity] follows
+};
+
+// Producer side
+class ShmRingWriter {
+public:
+    ShmRingWriter();
+    ~ShmRingWriter();
+
+    // Creates (or recreates) /dev/shm/<name> with `capacity` history slots
+    bool open(const std::string& name, size_t capacity = 1024);
+    // Unmaps and unlinks the segment
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    void publish(const SensorData& data);
+
+private:
+    ShmHeader* header_;
+    ShmSlot* history_;
+    size_t mapped_size_;
+    uint64_t mask_;
+    std::string name_;
+};
+
+// Consumer side. Thread-safe; reads never block the producer.
+class ShmRingReader {
+public:
+    ShmRingReader();
+    ~ShmRingReader();
+
+    bool open(const std::string& name);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    // Most recent sample; false if nothing has been written yet
+    bool readLatest(ShmSample& out) const;
+
+    // Copies up to max_count samples from `cursor` onwards and advances the
+    // cursor. Samples already overwritten are skipped and counted in `skipped`.
+    size_t readSince(uint64_t& cursor, ShmSample* out, size_t max_count, uint64_t* skipped = nullptr) const;
+
+    uint64_t writeIndex() const;
+    size_t capacity() const;
+
+private:
+    const ShmHeader* header_;
+    const ShmSlot* history_;
+    size_t mapped_size_;
+    uint64_t mask_;
+};
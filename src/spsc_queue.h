@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bounded single-producer/single-consumer queue. Storage is allocated (and
+// touched) in the constructor, so push() and pop() never allocate, lock or
+// make a syscall. push() fails instead of overwriting when the queue is full.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : capacity_(roundUpPow2(capacity))
+        , mask_(capacity_ - 1)
+        , slots_(capacity_)
+        , head_(0)
+        , tail_(0)
+    {
+    }
+
+    // Producer side
+    bool push(const T& value) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= capacity_) {
+            return false;
+        }
+        slots_[head & mask_] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& out) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = slots_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    size_t capacity_;
+    uint64_t mask_;
+    std::vector<T> slots_;
+    alignas(64) std::atomic<uint64_t> head_;  // written by the producer
+    alignas(64) std::atomic<uint64_t> tail_;  // written by the consumer
+};
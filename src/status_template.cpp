@@ -0,0 +1,77 @@
+#include "status_template.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr uint8_t kTimestampTag = (sensor::StatusMessage::kTimestampFieldNumber << 3) | 0;  // varint
+
+size_t encodeVarint(uint64_t value, uint8_t* out) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+} // namespace
+
+StatusTemplate::StatusTemplate()
+    : status_(sensor::StatusMessage::UNKNOWN)
+    , timestamp_offset_(0)
+    , timestamp_width_(0)
+    , rebuilds_(0)
+{
+}
+
+StatusTemplate::StatusTemplate(const std::string& device_id, sensor::StatusMessage::Status status, const std::string& message)
+    : device_id_(device_id)
+    , status_(status)
+    , message_(message)
+    , timestamp_offset_(0)
+    , timestamp_width_(0)
+    , rebuilds_(0)
+{
+}
+
+const std::string& StatusTemplate::at(int64_t timestamp_ms) {
+    uint8_t varint[10];
+    size_t width = encodeVarint(static_cast<uint64_t>(timestamp_ms), varint);
+    if (timestamp_ms != 0 && width == timestamp_width_) {
+        std::memcpy(&serialized_[timestamp_offset_], varint, width);
+    } else {
+        rebuild(timestamp_ms);
+    }
+    return serialized_;
+}
+
+void StatusTemplate::rebuild(int64_t timestamp_ms) {
+    sensor::StatusMessage msg;
+    msg.set_status(status_);
+    msg.set_device_id(device_id_);
+    msg.set_message(message_);
+
+    // Serializing with and without the timestamp locates its bytes without
+    // assuming anything about the serializer's field order
+    std::string without;
+    msg.SerializeToString(&without);
+    msg.set_timestamp(timestamp_ms);
+    if (!msg.SerializeToString(&serialized_)) {
+        std::cerr << "Failed to serialize status template to protobuf" << std::endl;
+    }
+    rebuilds_++;
+
+    timestamp_width_ = 0;
+    size_t offset = 0;
+    while (offset < without.size() && without[offset] == serialized_[offset]) {
+        offset++;
+    }
+    size_t added = serialized_.size() - without.size();
+    if (timestamp_ms != 0 && added > 1 && static_cast<uint8_t>(serialized_[offset]) == kTimestampTag &&
+        serialized_.compare(offset + added, std::string::npos, without, offset, std::string::npos) == 0) {
+        timestamp_offset_ = offset + 1;
+        timestamp_width_ = added - 1;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "sensor.pb.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Pre-serialized StatusMessage for one device and status.
+//
+// Only the timestamp changes between publishes, so the message is serialized
+// once and at() overwrites the timestamp varint in place. The template is
+// rebuilt only when the varint needs a different number of bytes, which for
+// Unix milliseconds does not happen before the year 2109.
+class StatusTemplate {
+public:
+    StatusTemplate();
+    StatusTemplate(const std::string& device_id, sensor::StatusMessage::Status status, const std::string& message);
+
+    // Serialized message stamped with timestamp_ms; valid until the next call
+    const std::string& at(int64_t timestamp_ms);
+
+    const std::string& deviceId() const { return device_id_; }
+    uint64_t rebuilds() const { return rebuilds_; }
+
+private:
+    void rebuild(int64_t timestamp_ms);
+
+    std::string device_id_;
+    sensor::StatusMessage::Status status_;
+    std::string message_;
+
+    std::string serialized_;
+    size_t timestamp_offset_;  // first byte of the timestamp varint
+    size_t timestamp_width_;   // 0 if the field is absent and cannot be patched
+    uint64_t rebuilds_;
+};
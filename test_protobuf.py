@@ -42,6 +42,7 @@ def on_message(client, userdata, msg):
             print(f"  Device ID: {sensor_data.device_id}")
             print(f"  Version: {sensor_data.version}")
             print(f"  Timestamp: {sensor_data.timestamp}")
+            print(f"  Sequence: {sensor_data.sequence}")
             
         elif topic == "sensor/temperature":
             temp_data = sensor_pb2.TemperatureData()
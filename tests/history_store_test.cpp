@@ -0,0 +1,133 @@
+// Regression test for the history spill file wrapping. Blocks of very
+// different compressed sizes are spilled through a small file until it has
+// wrapped several times, and after every sealed block a full query must
+// return each block intact, in order and exactly once.
+#include "history_store.h"
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kBlockSamples = 64;
+constexpr uint64_t kSpillBytes = 16 * 1024;
+constexpr uint64_t kBlocks = 400;
+
+// Every third block is constant and compresses to almost nothing; the others
+// carry pseudo-random values that barely compress
+double expectedValue(uint64_t sequence, int column) {
+    if ((sequence / kBlockSamples) % 3 == 0) {
+        return 10.0 * column;
+    }
+    uint64_t x = (sequence + 1) * 0x9E3779B97F4A7C15ull ^ (static_cast<uint64_t>(column) << 56);
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 29;
+    return static_cast<double>(x >> 11) / 9007199254740992.0 * 100.0;
+}
+
+SensorData sample(uint64_t sequence) {
+    SensorData data;
+    data.cpu_temperature = expectedValue(sequence, kHistoryTemperature);
+    data.compass_heading = expectedValue(sequence, kHistoryHeading);
+    data.gps_latitude = expectedValue(sequence, kHistoryLatitude);
+    data.gps_longitude = expectedValue(sequence, kHistoryLongitude);
+    data.gps_altitude = expectedValue(sequence, kHistoryAltitude);
+    data.gps_accuracy = expectedValue(sequence, kHistoryAccuracy);
+    data.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(1000000 + sequence * 10));
+    data.sequence = sequence;
+    return data;
+}
+
+// Queries everything and checks the blocks cover [first spilled, next) once, intact
+bool checkHistory(const HistoryStore& store, uint64_t next, std::string& error) {
+    std::vector<int64_t> timestamps, sequences;
+    std::vector<double> values;
+    uint64_t expected_next = 0;
+    bool first = true;
+    bool ok = true;
+    size_t visited = store.query(0, INT64_MAX, [&](const EncodedBlock& block) {
+        if (!decodeDeltaOfDelta(block.timestamps, block.count, timestamps) ||
+            !decodeDeltaOfDelta(block.sequences, block.count, sequences) ||
+            timestamps.size() != block.count || sequences.size() != block.count || block.count == 0) {
+            error = "block failed to decode";
+            return ok = false;
+        }
+        if (timestamps.front() != block.start_ms || timestamps.back() != block.end_ms) {
+            error = "block header does not match its timestamps";
+            return ok = false;
+        }
+        uint64_t start = static_cast<uint64_t>(sequences.front());
+        if (!first && start != expected_next) {
+            error = "expected sequence " + std::to_string(expected_next) + ", block starts at " + std::to_string(start);
+            return ok = false;
+        }
+        first = false;
+        for (int c = 0; c < kHistoryColumnCount; c++) {
+            if (!decodeXor(block.columns[c], block.count, values) || values.size() != block.count) {
+                error = "column failed to decode";
+                return ok = false;
+            }
+            for (uint32_t i = 0; i < block.count; i++) {
+                if (static_cast<uint64_t>(sequences[i]) != start + i || values[i] != expectedValue(start + i, c)) {
+                    error = "wrong sample in block starting at " + std::to_string(start);
+                    return ok = false;
+                }
+            }
+        }
+        expected_next = start + block.count;
+        return true;
+    });
+    if (!ok) {
+        return false;
+    }
+    HistoryStore::Stats stats = store.stats();
+    if (visited != stats.spilled_blocks + stats.memory_blocks || expected_next != next) {
+        error = "visited " + std::to_string(visited) + " blocks of " +
+                std::to_string(stats.spilled_blocks + stats.memory_blocks) + ", ending at sequence " +
+                std::to_string(expected_next) + " of " + std::to_string(next);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    HistoryStoreConfig config;
+    config.memory_bytes = 1;  // every sealed block but the newest spills
+    config.block_samples = kBlockSamples;
+    config.spill_path = argc > 1 ? argv[1] : "history_store_test.spill";
+    config.spill_bytes = kSpillBytes;
+    config.resolution.fill(0.0);
+
+    HistoryStore store(config);
+    if (!store.open()) {
+        return 1;
+    }
+
+    std::string error;
+    uint64_t sequence = 0;
+    for (uint64_t block = 0; block < kBlocks; block++) {
+        for (uint32_t i = 0; i < kBlockSamples; i++) {
+            store.append(sample(sequence++));
+        }
+        if (!checkHistory(store, sequence, error)) {
+            std::cerr << "FAIL after block " << block << ": " << error << std::endl;
+            std::remove(config.spill_path.c_str());
+            return 1;
+        }
+    }
+    std::remove(config.spill_path.c_str());
+
+    HistoryStore::Stats stats = store.stats();
+    uint64_t wraps = stats.compressed_bytes / kSpillBytes;
+    if (wraps < 3) {
+        std::cerr << "FAIL: spill file wrapped only " << wraps << " times" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: " << kBlocks << " blocks, spill file wrapped about " << wraps << " times, "
+              << stats.spilled_blocks << " blocks indexed at the end" << std::endl;
+    return 0;
+}